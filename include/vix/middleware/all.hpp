@@ -38,9 +38,26 @@
 #include <vix/middleware/app/http_cache.hpp>
 #include <vix/middleware/app/presets.hpp>
 
+// cache
+#include <vix/middleware/cache/cache_metrics.hpp>
+#include <vix/middleware/cache/cache_usage.hpp>
+#include <vix/middleware/cache/entry_bytes.hpp>
+#include <vix/middleware/cache/frequency_sketch.hpp>
+#include <vix/middleware/cache/l1_cache.hpp>
+#include <vix/middleware/cache/mmap_store.hpp>
+#include <vix/middleware/cache/private_cache.hpp>
+#include <vix/middleware/cache/query_key.hpp>
+#include <vix/middleware/cache/shared_entry.hpp>
+#include <vix/middleware/cache/striped_store.hpp>
+#include <vix/middleware/cache/tag_index.hpp>
+#include <vix/middleware/cache/tiered_store.hpp>
+#include <vix/middleware/cache/tinylfu_store.hpp>
+#include <vix/middleware/cache/warmup.hpp>
+
 // auth
 #include <vix/middleware/auth/api_key.hpp>
 #include <vix/middleware/auth/jwt.hpp>
+#include <vix/middleware/auth/principal.hpp>
 #include <vix/middleware/auth/rbac.hpp>
 #include <vix/middleware/auth/session.hpp>
 
@@ -53,6 +70,7 @@
 
 // http
 #include <vix/middleware/http/cookies.hpp>
+#include <vix/middleware/http/range.hpp>
 
 // observability
 #include <vix/middleware/observability/debug_trace.hpp>
@@ -67,7 +85,11 @@
 #include <vix/middleware/parsers/multipart_save.hpp>
 
 // performance
+#include <vix/middleware/performance/adaptive_compression.hpp>
+#include <vix/middleware/performance/body_stream.hpp>
 #include <vix/middleware/performance/compression.hpp>
+#include <vix/middleware/performance/compression_dictionary.hpp>
+#include <vix/middleware/performance/compression_memo.hpp>
 #include <vix/middleware/performance/etag.hpp>
 #include <vix/middleware/performance/static_files.hpp>
 
@@ -79,6 +101,7 @@
 #include <vix/middleware/security/rate_limit.hpp>
 
 // utils
+#include <vix/middleware/utils/body.hpp>
 #include <vix/middleware/utils/clock.hpp>
 #include <vix/middleware/utils/header_utils.hpp>
 #include <vix/middleware/utils/json_writer.hpp>
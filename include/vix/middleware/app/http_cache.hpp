@@ -13,17 +13,26 @@
 #ifndef VIX_HTTP_CACHE_HPP
 #define VIX_HTTP_CACHE_HPP
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <vix/middleware/app/adapter.hpp>
+#include <vix/middleware/cache/cache_metrics.hpp>
+#include <vix/middleware/cache/mmap_store.hpp>
+#include <vix/middleware/cache/private_cache.hpp>
+#include <vix/middleware/cache/striped_store.hpp>
+#include <vix/middleware/cache/tag_index.hpp>
+#include <vix/middleware/cache/tiered_store.hpp>
+#include <vix/middleware/cache/tinylfu_store.hpp>
+#include <vix/middleware/cache/warmup.hpp>
 #include <vix/middleware/http_cache.hpp>
 
 #include <vix/cache/Cache.hpp>
 #include <vix/cache/CachePolicy.hpp>
-#include <vix/cache/MemoryStore.hpp>
 
 namespace vix::middleware::app
 {
@@ -33,43 +42,242 @@ namespace vix::middleware::app
   struct HttpCacheAppConfig
   {
     std::string prefix{"/api/"};
-    bool only_get{true};
+    bool only_get{true}; // GET, plus HEAD answered from GET entries
     int ttl_ms{30'000};
 
+    /**
+     * @brief Serve entries up to this age when the handler fails (0 = off).
+     *
+     * Also widens the default cache policy's stale-if-error window.
+     */
+    int stale_if_error_ms{0};
+
+    /**
+     * @brief TTL of negative (404/410) entries (0 = no negative caching).
+     */
+    int negative_ttl_ms{0};
+
+    /**
+     * @brief Byte budget of the negative cache, separate from max_bytes.
+     */
+    std::size_t negative_max_bytes{4 * 1024 * 1024};
+
+    std::vector<int> negative_statuses{404, 410};
+
     bool allow_bypass{true};
     std::string bypass_header{"x-vix-cache"};
     std::string bypass_value{"bypass"};
 
     std::vector<std::string> vary_headers{};
+    vix::middleware::cache::QueryKeyOptions query_key{};
     std::shared_ptr<vix::cache::Cache> cache{};
 
+    /**
+     * @brief Byte budget of the default cache (0 = unbounded StripedStore).
+     *
+     * When set, the default cache uses a TinyLfuStore with TinyLFU admission
+     * and size-aware eviction. With disk_path, 0 means disk_max_bytes / 8
+     * instead: the memory tier is always bounded. Ignored when @ref cache is
+     * provided.
+     */
+    std::size_t max_bytes{0};
+
+    /**
+     * @brief Path of a persistent on-disk tier (empty = memory only).
+     *
+     * When set, the default cache puts the memory store in front of an
+     * MmapStore at this path. Entries survive restarts and the disk tier
+     * can hold more than fits in RAM. Ignored when @ref cache is provided.
+     */
+    std::string disk_path{};
+
+    /**
+     * @brief Byte budget of the on-disk tier.
+     */
+    std::size_t disk_max_bytes{1024ull * 1024 * 1024};
+
+    /**
+     * @brief Bytes buffered before the disk tier writes (see MmapStoreOptions::flush_bytes).
+     *
+     * Cache fills write the disk tier on the request thread; a larger
+     * batch means fewer write(2) calls but more entries lost on a crash.
+     */
+    std::size_t disk_flush_bytes{256 * 1024};
+
     bool add_debug_header{false};
     std::string debug_header{"x-vix-cache-status"};
+
+    bool encoded_variants{false};
+
+    /**
+     * @brief Store cached bodies gzip-compressed (see HttpCacheOptions::compress_at_rest).
+     *
+     * Combined with max_bytes, the same budget holds several times more
+     * text entries.
+     */
+    bool compress_at_rest{false};
+
+    /**
+     * @brief Per-thread L1 entries (0 = no L1), see cache::L1Cache.
+     */
+    std::size_t l1_entries{0};
+    std::int64_t l1_ttl_ms{1000};
+
+    /**
+     * @brief Per-principal private cache quota in bytes (0 = off).
+     *
+     * Requests with a principal are then cached per principal, with
+     * ttl_ms and an LRU within each partition. Needs principal.
+     */
+    std::size_t private_max_bytes{0};
+    std::size_t private_max_principals{10'000};
+
+    /**
+     * @brief Principal resolver, required for private caching.
+     *
+     * For jwt(), session() or api_key() installed before the cache, use
+     * auth::request_principal from <vix/middleware/auth/principal.hpp>
+     * (which depends on the JWT stack, hence not included here).
+     */
+    vix::middleware::cache::PrincipalResolver principal{};
+
+    /**
+     * @brief Tag/path-prefix invalidation index (optional).
+     *
+     * The default cache attaches its store to the index so invalidated
+     * entries are erased eagerly. Keep a copy of the pointer to call
+     * invalidate_tag() / invalidate_prefix() from handlers.
+     */
+    std::shared_ptr<vix::middleware::cache::CacheTagIndex> tag_index{};
+
+    /**
+     * @brief Cache metrics (optional).
+     *
+     * The default cache reports its resident bytes, entries and evictions
+     * to it. Keep a copy of the pointer to read snapshot().
+     */
+    std::shared_ptr<vix::middleware::cache::CacheMetrics> metrics{};
+
+    /**
+     * @brief Warm-up manifest replayed by install_http_cache() (optional).
+     *
+     * One GET target per line, see cache::parse_warmup_manifest().
+     */
+    std::string warmup_manifest{};
+
+    /**
+     * @brief Additional warm-up targets, e.g. from a service (optional).
+     */
+    std::function<std::vector<std::string>()> warmup_targets{};
+
+    /**
+     * @brief Handler warm-up targets are replayed through.
+     *
+     * Usually a dispatcher into the app's routes. Warm-up is skipped
+     * when it is not set. Only the cache middleware runs in front of it
+     * (see make_warmup_fetch()), not the App's middleware chain.
+     */
+    std::function<void(vix::http::Request &, vix::http::ResponseWrapper &)> warmup_handler{};
+
+    /**
+     * @brief Warm-up pool size and progress reporting.
+     */
+    vix::middleware::cache::WarmupOptions warmup{};
   };
 
   /**
    * @brief Create a default in-memory cache instance from app config.
    *
+   * Uses a byte-bounded TinyLfuStore when cfg.max_bytes is set, otherwise
+   * an unbounded, lock-striped StripedStore. With cfg.disk_path, a bounded
+   * memory store (cfg.max_bytes, or cfg.disk_max_bytes / 8) becomes the hot
+   * tier of a TieredStore backed by an MmapStore.
+   *
    * @param cfg App-level cache configuration.
    * @return Shared cache instance.
    */
   inline std::shared_ptr<vix::cache::Cache>
   make_default_cache(const HttpCacheAppConfig &cfg)
   {
-    auto store = std::make_shared<vix::cache::MemoryStore>();
+    std::shared_ptr<vix::cache::CacheStore> store;
+
+    std::size_t hot_max_bytes = cfg.max_bytes;
+    if (hot_max_bytes == 0 && !cfg.disk_path.empty())
+      hot_max_bytes = std::max<std::size_t>(cfg.disk_max_bytes / 8, 1);
+
+    if (hot_max_bytes > 0)
+    {
+      vix::middleware::cache::TinyLfuOptions sopt{};
+      sopt.max_bytes = hot_max_bytes;
+      store = std::make_shared<vix::middleware::cache::TinyLfuStore>(sopt);
+    }
+    else
+    {
+      store = std::make_shared<vix::middleware::cache::StripedStore>();
+    }
+
+    if (!cfg.disk_path.empty())
+    {
+      vix::middleware::cache::MmapStoreOptions dopt{};
+      dopt.path = cfg.disk_path;
+      dopt.max_bytes = cfg.disk_max_bytes;
+      dopt.flush_bytes = cfg.disk_flush_bytes;
+
+      store = std::make_shared<vix::middleware::cache::TieredStore>(
+          std::move(store),
+          std::make_shared<vix::middleware::cache::MmapStore>(std::move(dopt)));
+    }
+
+    if (cfg.tag_index)
+      cfg.tag_index->attach_store(store);
+
+    if (cfg.metrics)
+    {
+      if (auto usage = std::dynamic_pointer_cast<vix::middleware::cache::ICacheUsage>(store))
+        cfg.metrics->attach_usage(std::move(usage));
+    }
+
     vix::cache::CachePolicy policy;
     policy.ttl_ms = cfg.ttl_ms;
 
+    if (cfg.stale_if_error_ms > 0)
+    {
+      policy.allow_stale_if_error = true;
+      policy.stale_if_error_ms = cfg.stale_if_error_ms;
+    }
+
     return std::make_shared<vix::cache::Cache>(policy, store);
   }
 
   /**
-   * @brief Build an App middleware that caches HTTP responses.
+   * @brief Create the negative-response cache from app config.
    *
-   * @param cfg App-level cache configuration.
-   * @return App middleware.
+   * A small TinyLfuStore with its own budget and TTL, so negative entries
+   * never compete with real ones.
+   *
+   * @return Shared cache instance, or nullptr when cfg.negative_ttl_ms is 0.
    */
-  inline vix::App::Middleware http_cache_mw(HttpCacheAppConfig cfg = {})
+  inline std::shared_ptr<vix::cache::Cache>
+  make_negative_cache(const HttpCacheAppConfig &cfg)
+  {
+    if (cfg.negative_ttl_ms <= 0)
+      return nullptr;
+
+    vix::middleware::cache::TinyLfuOptions sopt{};
+    sopt.max_bytes = cfg.negative_max_bytes;
+    sopt.expected_entries = 4 * 1024;
+
+    vix::cache::CachePolicy policy;
+    policy.ttl_ms = cfg.negative_ttl_ms;
+
+    return std::make_shared<vix::cache::Cache>(
+        policy, std::make_shared<vix::middleware::cache::TinyLfuStore>(sopt));
+  }
+
+  /**
+   * @brief Build the cache middleware (Request, Response, Next) from app config.
+   */
+  inline vix::middleware::HttpMiddleware make_http_cache(HttpCacheAppConfig &cfg)
   {
     auto cache = cfg.cache ? std::move(cfg.cache) : make_default_cache(cfg);
 
@@ -78,34 +286,163 @@ namespace vix::middleware::app
     opt.bypass_header = cfg.bypass_header;
     opt.bypass_value = cfg.bypass_value;
     opt.vary_headers = std::move(cfg.vary_headers);
+    opt.query_key = std::move(cfg.query_key);
+    opt.encoded_variants = cfg.encoded_variants;
+    opt.compress_at_rest = cfg.compress_at_rest;
+
+    if (cfg.private_max_bytes > 0 && cfg.principal)
+    {
+      vix::middleware::cache::PrivateCacheOptions popt{};
+      popt.max_bytes_per_principal = cfg.private_max_bytes;
+      popt.max_principals = cfg.private_max_principals;
+      popt.ttl_ms = cfg.ttl_ms;
 
-    auto inner = vix::middleware::http_cache(std::move(cache), opt);
+      opt.private_cache = std::make_shared<vix::middleware::cache::PrivateCache>(popt);
+      opt.principal = std::move(cfg.principal);
+    }
+
+    if (cfg.l1_entries > 0)
+    {
+      vix::middleware::cache::L1CacheOptions l1{};
+      l1.capacity = cfg.l1_entries;
+      l1.ttl_ms = cfg.l1_ttl_ms;
+      opt.l1 = std::make_shared<vix::middleware::cache::L1Cache>(l1);
+    }
+    opt.tag_index = std::move(cfg.tag_index);
+    if (opt.tag_index && opt.private_cache)
+      opt.tag_index->attach_private_cache(opt.private_cache);
+    opt.metrics = std::move(cfg.metrics);
+    opt.stale_if_error_ms = cfg.stale_if_error_ms;
+    opt.negative_cache = make_negative_cache(cfg);
+    opt.negative_statuses = std::move(cfg.negative_statuses);
+
+    return vix::middleware::http_cache(std::move(cache), opt);
+  }
+
+  /**
+   * @brief Wrap a cache middleware for App, honoring cfg.only_get.
+   */
+  inline vix::App::Middleware adapt_http_cache(
+      vix::middleware::HttpMiddleware inner,
+      const HttpCacheAppConfig &cfg)
+  {
     auto mw = vix::middleware::app::adapt(std::move(inner));
 
     if (cfg.only_get)
     {
       mw = vix::middleware::app::when(
           [](const vix::http::Request &req)
-          { return req.method() == "GET"; },
+          { return req.method() == "GET" || req.method() == "HEAD"; },
           std::move(mw));
     }
 
     return mw;
   }
 
+  /**
+   * @brief Build an App middleware that caches HTTP responses.
+   *
+   * @param cfg App-level cache configuration.
+   * @return App middleware.
+   */
+  inline vix::App::Middleware http_cache_mw(HttpCacheAppConfig cfg = {})
+  {
+    auto inner = make_http_cache(cfg);
+    return adapt_http_cache(std::move(inner), cfg);
+  }
+
+  /**
+   * @brief Fetch function replaying a GET target through a cache middleware.
+   *
+   * The request goes to @p mw and then straight to @p handler, not
+   * through the App pipeline, and carries no Accept-Encoding or
+   * credentials. Warmed entries therefore only get the tags the handler
+   * adds itself (tag header or cache::add_cache_tags()), no encoded
+   * variants and no per-principal copies; compression() and the other
+   * App middlewares never see them. Compress-at-rest still applies, since
+   * the cache middleware does it.
+   *
+   * @param mw Cache middleware to fill.
+   * @param handler Handler producing the response on a miss.
+   */
+  inline vix::middleware::cache::WarmupFetch make_warmup_fetch(
+      vix::middleware::HttpMiddleware mw,
+      std::function<void(vix::http::Request &, vix::http::ResponseWrapper &)> handler)
+  {
+    return [mw = std::move(mw), handler = std::move(handler)](const std::string &target)
+    {
+      vix::http::Request::HeaderMap headers;
+      headers.emplace("Host", "localhost");
+      headers.emplace("User-Agent", "vix-cache-warmup");
+
+      vix::http::Request req("GET", target, std::move(headers), std::string{});
+      vix::http::Response res;
+      vix::http::ResponseWrapper w(res);
+
+      mw(req, w, [&]()
+         { handler(req, w); });
+
+      return static_cast<int>(res.status());
+    };
+  }
+
+  /**
+   * @brief Collect warm-up targets from cfg (manifest file, then callback).
+   */
+  inline std::vector<std::string> warmup_targets(const HttpCacheAppConfig &cfg)
+  {
+    std::vector<std::string> targets;
+
+    if (!cfg.warmup_manifest.empty())
+      targets = vix::middleware::cache::read_warmup_manifest(cfg.warmup_manifest);
+
+    if (cfg.warmup_targets)
+    {
+      for (auto &t : cfg.warmup_targets())
+        targets.push_back(std::move(t));
+    }
+
+    return targets;
+  }
+
   /**
    * @brief Install the HTTP cache middleware on an app prefix.
    *
+   * When cfg.warmup_handler is set, the warm-up targets are replayed
+   * through the cache before this returns, so the app starts serving
+   * with a hot cache. Targets outside cfg.prefix are skipped.
+   *
    * @param app Target application.
    * @param cfg App-level cache configuration.
+   * @return Warm-up report (empty when no warm-up ran).
    */
-  inline void install_http_cache(vix::App &app, HttpCacheAppConfig cfg = {})
+  inline vix::middleware::cache::WarmupReport
+  install_http_cache(vix::App &app, HttpCacheAppConfig cfg = {})
   {
     std::string prefix = cfg.prefix;
     cfg.prefix.clear();
 
-    auto mw = http_cache_mw(std::move(cfg));
+    auto inner = make_http_cache(cfg);
+
+    vix::middleware::cache::WarmupReport report;
+    if (cfg.warmup_handler)
+    {
+      auto targets = warmup_targets(cfg);
+      targets.erase(std::remove_if(targets.begin(), targets.end(),
+                                   [&](const std::string &t)
+                                   { return t.rfind(prefix, 0) != 0; }),
+                    targets.end());
+
+      report = vix::middleware::cache::warm_cache(
+          targets,
+          make_warmup_fetch(inner, cfg.warmup_handler),
+          cfg.warmup);
+    }
+
+    auto mw = adapt_http_cache(std::move(inner), cfg);
     vix::middleware::app::install(app, std::move(prefix), std::move(mw));
+
+    return report;
   }
 
 } // namespace vix::middleware::app
@@ -0,0 +1,84 @@
+/**
+ *
+ *  @file principal.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_PRINCIPAL_HPP
+#define VIX_PRINCIPAL_HPP
+
+#include <string>
+#include <string_view>
+
+#include <openssl/evp.h>
+
+#include <vix/middleware/middleware.hpp>
+#include <vix/middleware/auth/api_key.hpp>
+#include <vix/middleware/auth/jwt.hpp>
+#include <vix/middleware/auth/session.hpp>
+
+namespace vix::middleware::auth
+{
+  /**
+   * @brief Lowercase hex SHA-256 of @p data, or an empty string on failure.
+   */
+  inline std::string principal_digest(std::string_view data)
+  {
+    static constexpr char hex[] = "0123456789abcdef";
+
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+
+    if (EVP_Digest(data.data(), data.size(), md, &len, EVP_sha256(), nullptr) != 1)
+      return {};
+
+    std::string out;
+    out.reserve(len * 2);
+    for (unsigned int i = 0; i < len; ++i)
+    {
+      out.push_back(hex[md[i] >> 4]);
+      out.push_back(hex[md[i] & 0x0f]);
+    }
+    return out;
+  }
+
+  /**
+   * @brief Identify the authenticated principal of a request.
+   *
+   * Looks at the state left by the auth middlewares, in this order:
+   * - jwt(): "jwt:<subject>"
+   * - session(): "session:<id>" (destroyed sessions are ignored)
+   * - api_key(): "key:<sha256>", the 64-char lowercase hex SHA-256 of
+   *   the key, so the secret itself never ends up in cache keys, stats
+   *   or logs that carry the principal id
+   *
+   * The prefixes keep identifiers of different schemes apart.
+   *
+   * @return Principal id, or an empty string for anonymous requests.
+   */
+  inline std::string request_principal(Request &req)
+  {
+    if (auto *c = req.try_state<JwtClaims>(); c && !c->subject.empty())
+      return "jwt:" + c->subject;
+
+    if (auto *s = req.try_state<Session>(); s && !s->id.empty() && !s->destroyed)
+      return "session:" + s->id;
+
+    if (auto *k = req.try_state<ApiKey>(); k && !k->value.empty())
+    {
+      std::string digest = principal_digest(k->value);
+      return digest.empty() ? std::string{} : "key:" + digest;
+    }
+
+    return {};
+  }
+
+} // namespace vix::middleware::auth
+
+#endif // VIX_PRINCIPAL_HPP
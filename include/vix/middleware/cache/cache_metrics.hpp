@@ -0,0 +1,501 @@
+/**
+ *
+ *  @file cache_metrics.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_CACHE_METRICS_HPP
+#define VIX_MIDDLEWARE_CACHE_CACHE_METRICS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <vix/middleware/cache/cache_usage.hpp>
+#include <vix/middleware/observability/metrics.hpp>
+#include <vix/middleware/utils/clock.hpp>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Configuration options for CacheMetrics.
+   */
+  struct CacheMetricsOptions
+  {
+    /**
+     * @brief Metric name prefix (e.g. "<prefix>_hits_total").
+     */
+    std::string prefix{"vix_http_cache"};
+
+    /**
+     * @brief Path prefixes reported with their own hit ratio.
+     *
+     * Each request is attributed to the longest matching prefix, or to
+     * "other". Keep the list short: every entry is a label value.
+     */
+    std::vector<std::string> path_prefixes{};
+
+    /**
+     * @brief Number of keys returned by the top-keys snapshot lists.
+     */
+    std::size_t top_k{20};
+
+    /**
+     * @brief Feed 1 in N hits into top-key tracking (1 = every hit).
+     */
+    std::uint32_t hit_sample_every{8};
+
+    /**
+     * @brief Minimum delay between automatic pushes to the sink.
+     */
+    std::int64_t flush_interval_ms{1000};
+  };
+
+  /**
+   * @brief Cache events counted by CacheMetrics.
+   */
+  enum class CacheEvent
+  {
+    Hit,
+    Miss,
+    Bypass,
+    Store,
+    Stale, ///< expired entry served because the handler failed
+  };
+
+  /**
+   * @brief A key with an associated count or size.
+   */
+  struct CacheKeyStat
+  {
+    std::string key;
+    std::uint64_t value{0};
+  };
+
+  /**
+   * @brief Hit/miss counts of one path prefix.
+   */
+  struct CachePrefixStat
+  {
+    std::string prefix;
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    double hit_ratio{0.0};
+  };
+
+  /**
+   * @brief Point-in-time view of cache metrics.
+   */
+  struct CacheMetricsSnapshot
+  {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t bypasses{0};
+    std::uint64_t stores{0};
+    std::uint64_t stale{0};
+    double hit_ratio{0.0};
+
+    CacheUsage usage{};
+
+    std::vector<CachePrefixStat> prefixes{};
+
+    /** @brief Most hit keys (approximate: sampled, bounded tracking). */
+    std::vector<CacheKeyStat> top_hits{};
+
+    /** @brief Largest stored keys (bytes at store time). */
+    std::vector<CacheKeyStat> top_sizes{};
+  };
+
+  /**
+   * @brief Hit ratio, byte usage and eviction metrics for http_cache().
+   *
+   * Counting is cheap on the request path: counters live in cache-line
+   * separated shards, each thread increments its own shard with a relaxed
+   * atomic add, and shards are only summed by snapshot() and flush().
+   *
+   * Top keys use bounded trackers behind a mutex: hits are sampled
+   * (hit_sample_every) into a Space-Saving summary, stores feed a top-size
+   * table. Both hold at most 4 * top_k keys.
+   *
+   * When a sink is set, counter deltas and gauges are pushed to it at most
+   * every flush_interval_ms, from whichever request thread notices first:
+   * - <prefix>_hits_total / _misses_total {prefix}
+   * - <prefix>_bypass_total, _stores_total, _stale_total, _evictions_total
+   * - <prefix>_bytes, _entries, _hit_ratio {prefix} (gauges)
+   */
+  class CacheMetrics final
+  {
+  public:
+    explicit CacheMetrics(
+        CacheMetricsOptions opt = {},
+        std::shared_ptr<vix::middleware::observability::IMetricsSink> sink = nullptr)
+        : opt_(std::move(opt)),
+          sink_(std::move(sink)),
+          groups_(opt_.path_prefixes.size() + 1),
+          width_(round_up_(k_global + 2 * groups_))
+    {
+      for (auto &s : shards_)
+      {
+        s.c = std::make_unique<std::atomic<std::uint64_t>[]>(width_);
+        for (std::size_t i = 0; i < width_; ++i)
+          s.c[i].store(0, std::memory_order_relaxed);
+      }
+
+      flushed_.assign(k_global + 2 * groups_, 0);
+      last_flush_ms_.store(vix::middleware::utils::Clock::now_ms_steady(), std::memory_order_relaxed);
+    }
+
+    CacheMetrics(const CacheMetrics &) = delete;
+    CacheMetrics &operator=(const CacheMetrics &) = delete;
+
+    /**
+     * @brief Read resident bytes, entries and evictions from a store.
+     */
+    void attach_usage(std::shared_ptr<const ICacheUsage> usage)
+    {
+      std::lock_guard<std::mutex> lock(usage_mu_);
+      usage_ = std::move(usage);
+    }
+
+    /**
+     * @brief Count a cache event.
+     *
+     * @param ev Event.
+     * @param path Request path (selects the prefix group).
+     * @param key Cache key (top-key tracking).
+     * @param bytes Entry size, used for Store events.
+     */
+    void record(CacheEvent ev, std::string_view path, const std::string &key, std::size_t bytes = 0)
+    {
+      auto *c = shards_[shard_index_()].c.get();
+
+      switch (ev)
+      {
+      case CacheEvent::Hit:
+      {
+        const std::size_t g = group_of_(path);
+        c[k_global + 2 * g].fetch_add(1, std::memory_order_relaxed);
+
+        thread_local std::uint32_t tick = 0;
+        if (opt_.hit_sample_every <= 1 || ++tick % opt_.hit_sample_every == 0)
+          track_hit_(key);
+        break;
+      }
+      case CacheEvent::Miss:
+      {
+        const std::size_t g = group_of_(path);
+        c[k_global + 2 * g + 1].fetch_add(1, std::memory_order_relaxed);
+        break;
+      }
+      case CacheEvent::Bypass:
+        c[k_bypass].fetch_add(1, std::memory_order_relaxed);
+        break;
+      case CacheEvent::Store:
+        c[k_stores].fetch_add(1, std::memory_order_relaxed);
+        track_size_(key, bytes);
+        break;
+      case CacheEvent::Stale:
+        c[k_stale].fetch_add(1, std::memory_order_relaxed);
+        break;
+      }
+
+      maybe_flush_();
+    }
+
+    /**
+     * @brief Sum all counters and build the top-key lists.
+     */
+    CacheMetricsSnapshot snapshot() const
+    {
+      const std::vector<std::uint64_t> t = totals_();
+
+      CacheMetricsSnapshot s;
+      s.bypasses = t[k_bypass];
+      s.stores = t[k_stores];
+      s.stale = t[k_stale];
+      s.usage = read_usage_();
+
+      for (std::size_t g = 0; g < groups_; ++g)
+      {
+        CachePrefixStat p;
+        p.prefix = group_name_(g);
+        p.hits = t[k_global + 2 * g];
+        p.misses = t[k_global + 2 * g + 1];
+        p.hit_ratio = ratio_(p.hits, p.misses);
+
+        s.hits += p.hits;
+        s.misses += p.misses;
+        s.prefixes.push_back(std::move(p));
+      }
+      s.hit_ratio = ratio_(s.hits, s.misses);
+
+      std::lock_guard<std::mutex> lock(top_mu_);
+      s.top_hits = top_of_(top_hits_, opt_.top_k);
+      s.top_sizes = top_of_(top_sizes_, opt_.top_k);
+      return s;
+    }
+
+    /**
+     * @brief Push counter deltas and gauges to the sink now.
+     */
+    void flush()
+    {
+      if (!sink_)
+        return;
+
+      std::lock_guard<std::mutex> lock(flush_mu_);
+      last_flush_ms_.store(vix::middleware::utils::Clock::now_ms_steady(), std::memory_order_relaxed);
+
+      const std::vector<std::uint64_t> t = totals_();
+      auto delta = [&](std::size_t i)
+      {
+        const std::uint64_t d = t[i] - flushed_[i];
+        flushed_[i] = t[i];
+        return d;
+      };
+
+      const std::string &p = opt_.prefix;
+
+      if (auto d = delta(k_bypass))
+        sink_->inc_counter(p + "_bypass_total", {}, d);
+      if (auto d = delta(k_stores))
+        sink_->inc_counter(p + "_stores_total", {}, d);
+      if (auto d = delta(k_stale))
+        sink_->inc_counter(p + "_stale_total", {}, d);
+
+      for (std::size_t g = 0; g < groups_; ++g)
+      {
+        const std::string name = group_name_(g);
+        const std::uint64_t hits = t[k_global + 2 * g];
+        const std::uint64_t misses = t[k_global + 2 * g + 1];
+
+        if (auto d = delta(k_global + 2 * g))
+          sink_->inc_counter(p + "_hits_total", {{"prefix", name}}, d);
+        if (auto d = delta(k_global + 2 * g + 1))
+          sink_->inc_counter(p + "_misses_total", {{"prefix", name}}, d);
+
+        if (hits + misses > 0)
+          sink_->set_gauge(p + "_hit_ratio", ratio_(hits, misses), {{"prefix", name}});
+      }
+
+      const CacheUsage u = read_usage_();
+      if (u.evictions > flushed_evictions_)
+        sink_->inc_counter(p + "_evictions_total", {}, u.evictions - flushed_evictions_);
+      flushed_evictions_ = u.evictions;
+
+      sink_->set_gauge(p + "_bytes", static_cast<double>(u.bytes));
+      sink_->set_gauge(p + "_entries", static_cast<double>(u.entries));
+    }
+
+  private:
+    static constexpr std::size_t k_shards = 16;
+
+    // Counter slots; per-group hit/miss pairs follow k_global.
+    static constexpr std::size_t k_bypass = 0;
+    static constexpr std::size_t k_stores = 1;
+    static constexpr std::size_t k_stale = 2;
+    static constexpr std::size_t k_global = 3;
+
+    struct alignas(64) Shard
+    {
+      std::unique_ptr<std::atomic<std::uint64_t>[]> c;
+    };
+
+    /** @brief Round up to a whole number of 64-byte lines. */
+    static std::size_t round_up_(std::size_t n)
+    {
+      return (n + 7) / 8 * 8;
+    }
+
+    static std::size_t shard_index_()
+    {
+      thread_local const std::size_t idx =
+          std::hash<std::thread::id>{}(std::this_thread::get_id()) % k_shards;
+      return idx;
+    }
+
+    static double ratio_(std::uint64_t hits, std::uint64_t misses)
+    {
+      const std::uint64_t n = hits + misses;
+      return n == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(n);
+    }
+
+    static std::vector<CacheKeyStat> top_of_(
+        const std::unordered_map<std::string, std::uint64_t> &m,
+        std::size_t k)
+    {
+      std::vector<CacheKeyStat> out;
+      out.reserve(m.size());
+      for (const auto &kv : m)
+        out.push_back(CacheKeyStat{kv.first, kv.second});
+
+      std::sort(out.begin(), out.end(),
+                [](const CacheKeyStat &a, const CacheKeyStat &b)
+                { return a.value > b.value; });
+
+      if (out.size() > k)
+        out.resize(k);
+      return out;
+    }
+
+    std::size_t group_of_(std::string_view path) const
+    {
+      std::size_t best = groups_ - 1;
+      std::size_t best_len = 0;
+
+      for (std::size_t i = 0; i < opt_.path_prefixes.size(); ++i)
+      {
+        const std::string &p = opt_.path_prefixes[i];
+        if (p.size() >= best_len && path.substr(0, p.size()) == p)
+        {
+          best = i;
+          best_len = p.size();
+        }
+      }
+
+      return best;
+    }
+
+    std::string group_name_(std::size_t g) const
+    {
+      return g < opt_.path_prefixes.size() ? opt_.path_prefixes[g] : std::string("other");
+    }
+
+    std::vector<std::uint64_t> totals_() const
+    {
+      std::vector<std::uint64_t> t(k_global + 2 * groups_, 0);
+
+      for (const auto &s : shards_)
+      {
+        for (std::size_t i = 0; i < t.size(); ++i)
+          t[i] += s.c[i].load(std::memory_order_relaxed);
+      }
+
+      return t;
+    }
+
+    CacheUsage read_usage_() const
+    {
+      std::shared_ptr<const ICacheUsage> u;
+      {
+        std::lock_guard<std::mutex> lock(usage_mu_);
+        u = usage_;
+      }
+      return u ? u->usage() : CacheUsage{};
+    }
+
+    std::size_t top_capacity_() const
+    {
+      return std::max<std::size_t>(opt_.top_k, 1) * 4;
+    }
+
+    /**
+     * @brief Space-Saving update: a new key replaces the least counted one.
+     */
+    void track_hit_(const std::string &key)
+    {
+      std::lock_guard<std::mutex> lock(top_mu_);
+
+      auto it = top_hits_.find(key);
+      if (it != top_hits_.end())
+      {
+        ++it->second;
+        return;
+      }
+
+      if (top_hits_.size() < top_capacity_())
+      {
+        top_hits_.emplace(key, 1);
+        return;
+      }
+
+      auto min = std::min_element(top_hits_.begin(), top_hits_.end(),
+                                  [](const auto &a, const auto &b)
+                                  { return a.second < b.second; });
+      const std::uint64_t floor = min->second;
+      top_hits_.erase(min);
+      top_hits_.emplace(key, floor + 1);
+    }
+
+    void track_size_(const std::string &key, std::size_t bytes)
+    {
+      std::lock_guard<std::mutex> lock(top_mu_);
+
+      auto it = top_sizes_.find(key);
+      if (it != top_sizes_.end())
+      {
+        it->second = bytes;
+        return;
+      }
+
+      if (top_sizes_.size() >= top_capacity_())
+      {
+        auto min = std::min_element(top_sizes_.begin(), top_sizes_.end(),
+                                    [](const auto &a, const auto &b)
+                                    { return a.second < b.second; });
+        if (min->second >= bytes)
+          return;
+        top_sizes_.erase(min);
+      }
+
+      top_sizes_.emplace(key, bytes);
+    }
+
+    void maybe_flush_()
+    {
+      if (!sink_)
+        return;
+
+      const std::int64_t now = vix::middleware::utils::Clock::now_ms_steady();
+      std::int64_t last = last_flush_ms_.load(std::memory_order_relaxed);
+
+      if (now - last < opt_.flush_interval_ms)
+        return;
+
+      // Only one thread wins the slot; the others keep serving.
+      if (!last_flush_ms_.compare_exchange_strong(last, now, std::memory_order_relaxed))
+        return;
+
+      flush();
+    }
+
+  private:
+    CacheMetricsOptions opt_{};
+    std::shared_ptr<vix::middleware::observability::IMetricsSink> sink_{};
+
+    std::size_t groups_{1};
+    std::size_t width_{0};
+    Shard shards_[k_shards]{};
+
+    mutable std::mutex usage_mu_;
+    std::shared_ptr<const ICacheUsage> usage_{};
+
+    mutable std::mutex top_mu_;
+    std::unordered_map<std::string, std::uint64_t> top_hits_{};
+    std::unordered_map<std::string, std::uint64_t> top_sizes_{};
+
+    std::mutex flush_mu_;
+    std::atomic<std::int64_t> last_flush_ms_{0};
+    std::vector<std::uint64_t> flushed_{};
+    std::uint64_t flushed_evictions_{0};
+  };
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_CACHE_METRICS_HPP
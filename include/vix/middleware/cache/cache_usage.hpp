@@ -0,0 +1,48 @@
+/**
+ *
+ *  @file cache_usage.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_CACHE_USAGE_HPP
+#define VIX_MIDDLEWARE_CACHE_CACHE_USAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Resource usage of a cache store.
+   */
+  struct CacheUsage
+  {
+    std::size_t bytes{0};
+    std::size_t entries{0};
+    std::uint64_t evictions{0};
+  };
+
+  /**
+   * @brief Store capability: report resident bytes, entries and evictions.
+   *
+   * Implemented by middleware-provided stores next to
+   * vix::cache::CacheStore and read by CacheMetrics.
+   */
+  class ICacheUsage
+  {
+  public:
+    virtual ~ICacheUsage() = default;
+
+    /** @brief Current usage snapshot. */
+    virtual CacheUsage usage() const = 0;
+  };
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_CACHE_USAGE_HPP
@@ -0,0 +1,50 @@
+/**
+ *
+ *  @file entry_bytes.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_ENTRY_BYTES_HPP
+#define VIX_MIDDLEWARE_CACHE_ENTRY_BYTES_HPP
+
+#include <cstddef>
+#include <string>
+
+#include <vix/cache/CacheEntry.hpp>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Fixed per-entry bookkeeping cost charged to byte budgets.
+   *
+   * Covers node, hash bucket and string headers so that many tiny entries
+   * cannot slip under a byte budget.
+   */
+  inline constexpr std::size_t k_entry_overhead_bytes = 96;
+
+  /**
+   * @brief Approximate resident size of a cache entry (key + body + headers).
+   *
+   * @param key Cache key.
+   * @param e Cache entry.
+   * @return Approximate bytes held by the entry.
+   */
+  inline std::size_t entry_bytes(const std::string &key, const vix::cache::CacheEntry &e)
+  {
+    std::size_t n = k_entry_overhead_bytes + key.size() + e.body.size();
+
+    for (const auto &kv : e.headers)
+      n += kv.first.size() + kv.second.size();
+
+    return n;
+  }
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_ENTRY_BYTES_HPP
@@ -0,0 +1,137 @@
+/**
+ *
+ *  @file frequency_sketch.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_FREQUENCY_SKETCH_HPP
+#define VIX_MIDDLEWARE_CACHE_FREQUENCY_SKETCH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Count-min sketch with small saturating counters and periodic aging.
+   *
+   * Estimates how often a key hash was seen recently, using a fixed amount
+   * of memory regardless of how many distinct keys flow through. This is the
+   * frequency filter behind TinyLFU admission:
+   * - 4 rows of 4-bit-range counters (stored as bytes, saturating at 15)
+   * - every `sample_size` increments, all counters are halved so that old
+   *   popularity fades and the sketch follows the current workload
+   *
+   * Not thread-safe; the owning store serializes access.
+   */
+  class FrequencySketch final
+  {
+  public:
+    /** @brief Maximum value a single counter can reach. */
+    static constexpr std::uint8_t k_max_count = 15;
+
+    /**
+     * @brief Construct a sketch sized for roughly @p expected_keys distinct keys.
+     *
+     * @param expected_keys Expected number of resident keys (clamped to >= 64).
+     */
+    explicit FrequencySketch(std::size_t expected_keys = 4096)
+    {
+      std::size_t w = 64;
+      while (w < expected_keys)
+        w <<= 1;
+
+      width_ = w;
+      mask_ = w - 1;
+      sample_size_ = w * 10;
+      table_.assign(width_ * k_depth, 0);
+    }
+
+    /**
+     * @brief Record one access of @p hash.
+     */
+    void increment(std::uint64_t hash)
+    {
+      bool added = false;
+
+      for (std::size_t row = 0; row < k_depth; ++row)
+      {
+        auto &c = table_[row * width_ + index_(hash, row)];
+        if (c < k_max_count)
+        {
+          ++c;
+          added = true;
+        }
+      }
+
+      if (added && ++additions_ >= sample_size_)
+        age_();
+    }
+
+    /**
+     * @brief Estimated recent access count of @p hash (0..15).
+     */
+    std::uint8_t estimate(std::uint64_t hash) const
+    {
+      std::uint8_t f = k_max_count;
+
+      for (std::size_t row = 0; row < k_depth; ++row)
+        f = std::min(f, table_[row * width_ + index_(hash, row)]);
+
+      return f;
+    }
+
+    /** @brief Drop all recorded frequencies. */
+    void clear()
+    {
+      std::fill(table_.begin(), table_.end(), std::uint8_t{0});
+      additions_ = 0;
+    }
+
+    /** @brief Number of counters per row. */
+    std::size_t width() const noexcept { return width_; }
+
+  private:
+    static constexpr std::size_t k_depth = 4;
+
+    /**
+     * @brief Counter index of @p hash in @p row (double hashing).
+     */
+    std::size_t index_(std::uint64_t hash, std::size_t row) const
+    {
+      std::uint64_t h2 = hash * 0x9e3779b97f4a7c15ULL;
+      h2 ^= h2 >> 32;
+      const std::uint64_t h = hash + static_cast<std::uint64_t>(row) * (h2 | 1ULL);
+      return static_cast<std::size_t>(h ^ (h >> 29)) & mask_;
+    }
+
+    /**
+     * @brief Halve every counter (TinyLFU reset).
+     */
+    void age_()
+    {
+      for (auto &c : table_)
+        c = static_cast<std::uint8_t>(c >> 1);
+
+      additions_ /= 2;
+    }
+
+  private:
+    std::size_t width_{64};
+    std::size_t mask_{63};
+    std::size_t sample_size_{640};
+    std::size_t additions_{0};
+    std::vector<std::uint8_t> table_{};
+  };
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_FREQUENCY_SKETCH_HPP
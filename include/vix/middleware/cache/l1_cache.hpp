@@ -0,0 +1,212 @@
+/**
+ *
+ *  @file l1_cache.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_L1_CACHE_HPP
+#define VIX_MIDDLEWARE_CACHE_L1_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <vix/middleware/cache/shared_entry.hpp>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Options for L1Cache.
+   */
+  struct L1CacheOptions
+  {
+    /**
+     * @brief Entries per thread (rounded up to a power of two).
+     */
+    std::size_t capacity{256};
+
+    /**
+     * @brief Maximum time an entry is served from L1 without going back to
+     * the shared cache. Bounds how stale a thread can be after another
+     * thread replaced the entry.
+     */
+    std::int64_t ttl_ms{1000};
+
+    /**
+     * @brief Larger bodies are not kept in L1.
+     */
+    std::size_t max_entry_bytes{256 * 1024};
+  };
+
+  /**
+   * @brief Small per-thread cache in front of the shared vix::cache::Cache.
+   *
+   * Each thread owns a 2-way set-associative table of refcounted entries
+   * it built itself, so a hit touches thread-local memory only: no lock
+   * and no write to a cache line shared with other cores. A hit returns
+   * the entry by refcount; http_cache() then copies its body once into
+   * the response.
+   *
+   * Validity:
+   * - an entry lives at most ttl_ms in L1
+   * - every entry is stamped with an epoch; bump() (or a change of the
+   *   external epoch passed by the caller, e.g. CacheTagIndex::generation())
+   *   drops every thread's copies on their next lookup
+   *
+   * Tables are created lazily per (thread, instance) and freed when the
+   * thread exits.
+   */
+  class L1Cache final
+  {
+  public:
+    explicit L1Cache(L1CacheOptions opt = {})
+        : opt_(std::move(opt)),
+          id_(next_id_())
+    {
+      std::size_t cap = 2;
+      while (cap < opt_.capacity)
+        cap <<= 1;
+      mask_ = cap - 1;
+    }
+
+    L1Cache(const L1Cache &) = delete;
+    L1Cache &operator=(const L1Cache &) = delete;
+
+    /**
+     * @brief Look up an entry in the calling thread's table.
+     *
+     * @param key Cache key.
+     * @param now_ms Current steady time.
+     * @param external_epoch Epoch of an external invalidation source (or 0).
+     * @return The entry, or nullptr on miss.
+     */
+    SharedEntry get(const std::string &key, std::int64_t now_ms, std::uint64_t external_epoch = 0) const
+    {
+      const std::size_t h = std::hash<std::string>{}(key);
+      const std::uint64_t epoch = epoch_(external_epoch);
+      auto &slots = slots_();
+
+      for (std::size_t i = 0; i < 2; ++i)
+      {
+        Slot &s = slots[(h + i) & mask_];
+        if (!s.entry || s.hash != h || s.key != key)
+          continue;
+
+        if (s.epoch != epoch || now_ms >= s.expires_at_ms)
+        {
+          s.entry.reset();
+          return nullptr;
+        }
+        return s.entry;
+      }
+
+      return nullptr;
+    }
+
+    /**
+     * @brief Insert an entry into the calling thread's table.
+     *
+     * Replaces the same key, else an empty or expired slot, else the slot
+     * expiring first.
+     *
+     * @param external_epoch Same value as passed to get().
+     */
+    void put(const std::string &key, SharedEntry entry, std::int64_t now_ms, std::uint64_t external_epoch = 0)
+    {
+      if (!entry || entry->body.size() > opt_.max_entry_bytes)
+        return;
+
+      const std::size_t h = std::hash<std::string>{}(key);
+      auto &slots = slots_();
+
+      Slot *victim = nullptr;
+      for (std::size_t i = 0; i < 2; ++i)
+      {
+        Slot &s = slots[(h + i) & mask_];
+        if (s.entry && s.hash == h && s.key == key)
+        {
+          victim = &s;
+          break;
+        }
+        if (!victim || !s.entry || s.expires_at_ms < victim->expires_at_ms)
+          victim = &s;
+      }
+
+      victim->hash = h;
+      victim->key = key;
+      victim->entry = std::move(entry);
+      victim->epoch = epoch_(external_epoch);
+      victim->expires_at_ms = now_ms + opt_.ttl_ms;
+    }
+
+    /**
+     * @brief Invalidate every thread's entries.
+     */
+    void bump() noexcept
+    {
+      epoch_base_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    const L1CacheOptions &options() const noexcept { return opt_; }
+
+  private:
+    struct Slot
+    {
+      std::size_t hash{0};
+      std::string key{};
+      SharedEntry entry{};
+      std::uint64_t epoch{0};
+      std::int64_t expires_at_ms{0};
+    };
+
+    static std::uint64_t next_id_()
+    {
+      static std::atomic<std::uint64_t> ids{0};
+      return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    std::uint64_t epoch_(std::uint64_t external_epoch) const noexcept
+    {
+      return epoch_base_.load(std::memory_order_acquire) + external_epoch;
+    }
+
+    /** @brief Calling thread's table for this instance. */
+    std::vector<Slot> &slots_() const
+    {
+      thread_local std::unordered_map<std::uint64_t, std::vector<Slot>> tables;
+      thread_local std::uint64_t last_id = 0;
+      thread_local std::vector<Slot> *last = nullptr;
+
+      if (last_id == id_)
+        return *last;
+
+      auto &t = tables[id_];
+      if (t.empty())
+        t.resize(mask_ + 1);
+
+      last_id = id_;
+      last = &t;
+      return t;
+    }
+
+  private:
+    L1CacheOptions opt_;
+    std::uint64_t id_{0};
+    std::size_t mask_{0};
+    std::atomic<std::uint64_t> epoch_base_{0};
+  };
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_L1_CACHE_HPP
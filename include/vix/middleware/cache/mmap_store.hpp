@@ -0,0 +1,940 @@
+/**
+ *
+ *  @file mmap_store.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_MMAP_STORE_HPP
+#define VIX_MIDDLEWARE_CACHE_MMAP_STORE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/types.h>
+#endif
+
+#include <vix/cache/CacheEntry.hpp>
+#include <vix/cache/CacheStore.hpp>
+
+#include <vix/middleware/cache/cache_usage.hpp>
+#include <vix/middleware/utils/clock.hpp>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Configuration options for MmapStore.
+   */
+  struct MmapStoreOptions
+  {
+    /**
+     * @brief Cache file path. Created if missing, reloaded if present.
+     */
+    std::string path{"vix_http_cache.dat"};
+
+    /**
+     * @brief Budget for live record bytes on disk.
+     *
+     * When exceeded, the oldest written records are dropped first.
+     */
+    std::size_t max_bytes{1024ull * 1024 * 1024};
+
+    /**
+     * @brief Minimum dead bytes before the file is compacted.
+     *
+     * Compaction also requires dead bytes to outweigh live bytes, so the
+     * file never grows beyond roughly twice the live data.
+     */
+    std::size_t compact_min_bytes{16 * 1024 * 1024};
+
+    /**
+     * @brief Compact from put() once the thresholds above are reached.
+     *
+     * Compaction rewrites every live record while holding the store mutex,
+     * so the put() that triggers it and every concurrent lookup wait for
+     * a full copy of the live set. Set to false and call
+     * MmapStore::compact() from a maintenance thread to keep that stall
+     * off the request path.
+     */
+    bool auto_compact{true};
+
+    /**
+     * @brief Appended bytes buffered before they are written to the file.
+     *
+     * put() only copies the record into the stdio buffer; the write(2)
+     * happens once this many bytes are pending, when a pending record is
+     * read back, on erase(), flush() and close. Records still buffered
+     * when the process dies are lost (recovery truncates a torn tail).
+     * erase() writes its tombstone at once, since a lost one would bring
+     * an invalidated entry back. 0 writes every record immediately.
+     */
+    std::size_t flush_bytes{256 * 1024};
+  };
+
+  /**
+   * @brief Counters exposed by MmapStore.
+   */
+  struct MmapStoreStats
+  {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t writes{0};
+    std::uint64_t evictions{0};
+    std::uint64_t compactions{0};
+    std::size_t recovered{0};
+    std::size_t live_bytes{0};
+    std::size_t file_bytes{0};
+    std::size_t entries{0};
+  };
+
+  /**
+   * @brief Persistent, append-structured cache store read through mmap.
+   *
+   * Entries are appended to a single log file; erasures append a small
+   * tombstone record. An in-memory index maps keys to record offsets and is
+   * rebuilt by scanning the log on open, so a restarted process starts with
+   * everything written before it stopped. A torn tail (crash mid-write) is
+   * detected by checksum and truncated.
+   *
+   * Reads go through a read-only mapping of the file on POSIX systems and
+   * through buffered reads elsewhere. The file is compacted once dead
+   * records dominate it; by default that happens inside the put() that
+   * crosses the threshold and blocks the store for the whole rewrite (see
+   * MmapStoreOptions::auto_compact).
+   *
+   * Entry ages survive restarts: a record stores the entry age and the wall
+   * clock at write time, and created_at_ms is rebased onto the current
+   * steady clock when read back.
+   *
+   * put() and erase() run on the caller's thread under the store mutex:
+   * each encodes the record and appends it to a stdio buffer, which is
+   * written out every MmapStoreOptions::flush_bytes (erase() writes at
+   * once). If a write fails, the unwritten tail is dropped and tombstones
+   * of records erased meanwhile are written again. Nothing is fsync'ed.
+   *
+   * The file is owned by a single process and uses the host byte order.
+   * Thread-safe (single mutex).
+   */
+  class MmapStore final : public vix::cache::CacheStore,
+                          public ICacheUsage
+  {
+  public:
+    explicit MmapStore(MmapStoreOptions opt = {})
+        : opt_(std::move(opt))
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      open_locked_();
+    }
+
+    ~MmapStore() override
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      close_locked_();
+    }
+
+    MmapStore(const MmapStore &) = delete;
+    MmapStore &operator=(const MmapStore &) = delete;
+
+    void put(const std::string &key, const vix::cache::CacheEntry &entry) override
+    {
+      const std::string rec = encode_(key, &entry);
+
+      std::lock_guard<std::mutex> lock(mu_);
+      if (!file_ || key.empty() || rec.size() > opt_.max_bytes)
+        return;
+
+      auto it = index_.find(key);
+      if (it != index_.end())
+        drop_locked_(it);
+
+      if (!append_locked_(key, rec))
+        return;
+
+      ++stats_.writes;
+
+      while (live_bytes_ > opt_.max_bytes && !order_.empty())
+      {
+        erase_locked_(order_.begin()->second, false);
+        ++stats_.evictions;
+      }
+
+      maybe_compact_locked_();
+    }
+
+    std::optional<vix::cache::CacheEntry> get(const std::string &key) override
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+
+      auto it = index_.find(key);
+      if (it == index_.end())
+      {
+        ++stats_.misses;
+        return std::nullopt;
+      }
+
+      const char *p = read_locked_(it->second.offset, it->second.size);
+      auto e = p ? decode_(std::string_view(p, it->second.size)) : std::nullopt;
+
+      if (!e)
+      {
+        drop_locked_(it);
+        ++stats_.misses;
+        return std::nullopt;
+      }
+
+      ++stats_.hits;
+      return e;
+    }
+
+    void erase(const std::string &key) override
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (index_.find(key) != index_.end())
+        erase_locked_(key, true);
+    }
+
+    void clear() override
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      close_locked_();
+      reset_file_locked_();
+    }
+
+    /** @brief True if the cache file could be opened. */
+    bool is_open() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return file_ != nullptr;
+    }
+
+    /** @brief Number of resident entries. */
+    std::size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return index_.size();
+    }
+
+    /** @brief Snapshot of store counters. */
+    MmapStoreStats stats() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      MmapStoreStats s = stats_;
+      s.live_bytes = live_bytes_;
+      s.file_bytes = static_cast<std::size_t>(file_bytes_);
+      s.entries = index_.size();
+      return s;
+    }
+
+    CacheUsage usage() const override
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return CacheUsage{live_bytes_, index_.size(), stats_.evictions};
+    }
+
+    /** @brief Write buffered records to the file. */
+    bool flush()
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return file_ && flush_locked_();
+    }
+
+    /** @brief Force a compaction of the cache file. */
+    void compact()
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (file_)
+        compact_locked_();
+    }
+
+  private:
+    static constexpr char k_file_magic[8] = {'V', 'I', 'X', 'C', 'A', 'C', 'H', '1'};
+    static constexpr std::uint32_t k_record_magic = 0x52435856u; // "VXCR"
+    static constexpr std::uint32_t k_flag_erase = 1u;
+    static constexpr std::size_t k_record_header = 48;
+
+    struct RecordHeader
+    {
+      std::uint32_t magic{k_record_magic};
+      std::uint32_t flags{0};
+      std::uint32_t key_len{0};
+      std::uint32_t payload_len{0};
+      std::int32_t status{0};
+      std::uint32_t header_count{0};
+      std::int64_t age_ms{0};
+      std::int64_t written_epoch_ms{0};
+      std::uint32_t checksum{0};
+      std::uint32_t reserved{0};
+    };
+
+    struct Loc
+    {
+      std::uint64_t offset{0};
+      std::size_t size{0};
+    };
+
+    using Index = std::unordered_map<std::string, Loc>;
+
+    static std::uint32_t fnv1a_(std::string_view s, std::uint32_t h = 2166136261u)
+    {
+      for (unsigned char c : s)
+      {
+        h ^= c;
+        h *= 16777619u;
+      }
+      return h;
+    }
+
+    template <typename T>
+    static void put_raw_(std::string &out, T v)
+    {
+      char buf[sizeof(T)];
+      std::memcpy(buf, &v, sizeof(T));
+      out.append(buf, sizeof(T));
+    }
+
+    template <typename T>
+    static T get_raw_(const char *p)
+    {
+      T v;
+      std::memcpy(&v, p, sizeof(T));
+      return v;
+    }
+
+    static void write_header_(char *p, const RecordHeader &h)
+    {
+      std::memcpy(p + 0, &h.magic, 4);
+      std::memcpy(p + 4, &h.flags, 4);
+      std::memcpy(p + 8, &h.key_len, 4);
+      std::memcpy(p + 12, &h.payload_len, 4);
+      std::memcpy(p + 16, &h.status, 4);
+      std::memcpy(p + 20, &h.header_count, 4);
+      std::memcpy(p + 24, &h.age_ms, 8);
+      std::memcpy(p + 32, &h.written_epoch_ms, 8);
+      std::memcpy(p + 40, &h.checksum, 4);
+      std::memcpy(p + 44, &h.reserved, 4);
+    }
+
+    static RecordHeader read_header_(const char *p)
+    {
+      RecordHeader h;
+      h.magic = get_raw_<std::uint32_t>(p + 0);
+      h.flags = get_raw_<std::uint32_t>(p + 4);
+      h.key_len = get_raw_<std::uint32_t>(p + 8);
+      h.payload_len = get_raw_<std::uint32_t>(p + 12);
+      h.status = get_raw_<std::int32_t>(p + 16);
+      h.header_count = get_raw_<std::uint32_t>(p + 20);
+      h.age_ms = get_raw_<std::int64_t>(p + 24);
+      h.written_epoch_ms = get_raw_<std::int64_t>(p + 32);
+      h.checksum = get_raw_<std::uint32_t>(p + 40);
+      h.reserved = get_raw_<std::uint32_t>(p + 44);
+      return h;
+    }
+
+    /**
+     * @brief Serialize a record (tombstone when @p e is null).
+     */
+    static std::string encode_(const std::string &key, const vix::cache::CacheEntry *e)
+    {
+      std::string payload;
+      RecordHeader h;
+
+      if (e)
+      {
+        std::size_t n = e->body.size();
+        for (const auto &kv : e->headers)
+          n += 8 + kv.first.size() + kv.second.size();
+        payload.reserve(n);
+
+        for (const auto &kv : e->headers)
+        {
+          put_raw_(payload, static_cast<std::uint32_t>(kv.first.size()));
+          put_raw_(payload, static_cast<std::uint32_t>(kv.second.size()));
+          payload += kv.first;
+          payload += kv.second;
+        }
+        payload += e->body;
+
+        h.status = e->status;
+        h.header_count = static_cast<std::uint32_t>(e->headers.size());
+        h.age_ms = std::max<std::int64_t>(
+            0, vix::middleware::utils::Clock::now_ms_steady() - e->created_at_ms);
+        h.written_epoch_ms = vix::middleware::utils::Clock::now_ms_epoch();
+      }
+      else
+      {
+        h.flags = k_flag_erase;
+      }
+
+      h.key_len = static_cast<std::uint32_t>(key.size());
+      h.payload_len = static_cast<std::uint32_t>(payload.size());
+      h.checksum = fnv1a_(payload, fnv1a_(key));
+
+      std::string rec(k_record_header, '\0');
+      write_header_(rec.data(), h);
+      rec.reserve(k_record_header + key.size() + payload.size());
+      rec += key;
+      rec += payload;
+      return rec;
+    }
+
+    /**
+     * @brief Decode a full record into an entry.
+     */
+    static std::optional<vix::cache::CacheEntry> decode_(std::string_view rec)
+    {
+      if (rec.size() < k_record_header)
+        return std::nullopt;
+
+      const RecordHeader h = read_header_(rec.data());
+      if (rec.size() < k_record_header + static_cast<std::size_t>(h.key_len) + h.payload_len)
+        return std::nullopt;
+      std::string_view payload = rec.substr(k_record_header + h.key_len, h.payload_len);
+
+      vix::cache::CacheEntry e;
+      e.status = h.status;
+
+      std::size_t pos = 0;
+      for (std::uint32_t i = 0; i < h.header_count; ++i)
+      {
+        if (payload.size() - pos < 8)
+          return std::nullopt;
+
+        const auto kl = get_raw_<std::uint32_t>(payload.data() + pos);
+        const auto vl = get_raw_<std::uint32_t>(payload.data() + pos + 4);
+        pos += 8;
+
+        if (payload.size() - pos < static_cast<std::size_t>(kl) + vl)
+          return std::nullopt;
+
+        e.headers.emplace(std::string(payload.substr(pos, kl)),
+                          std::string(payload.substr(pos + kl, vl)));
+        pos += static_cast<std::size_t>(kl) + vl;
+      }
+
+      e.body.assign(payload.substr(pos));
+
+      // Rebase the age onto this process' steady clock (wall time that
+      // passed since the write counts, a clock going backwards does not).
+      const std::int64_t since_write = std::max<std::int64_t>(
+          0, vix::middleware::utils::Clock::now_ms_epoch() - h.written_epoch_ms);
+      e.created_at_ms =
+          vix::middleware::utils::Clock::now_ms_steady() - h.age_ms - since_write;
+
+      return e;
+    }
+
+    static bool seek_(std::FILE *f, std::uint64_t offset)
+    {
+#if defined(_WIN32)
+      return ::_fseeki64(f, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+      return ::fseeko(f, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+
+    /**
+     * @brief Open (or create) the cache file and rebuild the index.
+     *
+     * Caller must hold mu_.
+     */
+    void open_locked_()
+    {
+      std::error_code ec;
+      const bool exists = std::filesystem::exists(opt_.path, ec);
+
+      if (!exists)
+      {
+        reset_file_locked_();
+        return;
+      }
+
+      file_ = std::fopen(opt_.path.c_str(), "r+b");
+      if (!file_)
+        return;
+
+      file_bytes_ = std::filesystem::file_size(opt_.path, ec);
+      if (ec)
+        file_bytes_ = 0;
+
+      char magic[sizeof(k_file_magic)] = {};
+      if (file_bytes_ < sizeof(k_file_magic) || !seek_(file_, 0) ||
+          std::fread(magic, 1, sizeof(magic), file_) != sizeof(magic) ||
+          std::memcmp(magic, k_file_magic, sizeof(magic)) != 0)
+      {
+        close_locked_();
+        reset_file_locked_();
+        return;
+      }
+
+      flushed_bytes_ = file_bytes_;
+      at_end_ = false;
+      recover_locked_();
+    }
+
+    /**
+     * @brief Scan the log, rebuild the index and truncate a torn tail.
+     *
+     * Caller must hold mu_.
+     */
+    void recover_locked_()
+    {
+      std::uint64_t off = sizeof(k_file_magic);
+
+      while (off + k_record_header <= file_bytes_)
+      {
+        const char *hp = read_locked_(off, k_record_header);
+        if (!hp)
+          break;
+
+        const RecordHeader h = read_header_(hp);
+        const std::size_t size =
+            k_record_header + static_cast<std::size_t>(h.key_len) + h.payload_len;
+
+        if (h.magic != k_record_magic || off + size > file_bytes_)
+          break;
+
+        const char *p = read_locked_(off, size);
+        if (!p)
+          break;
+
+        const std::string_view key(p + k_record_header, h.key_len);
+        const std::string_view payload(p + k_record_header + h.key_len, h.payload_len);
+        if (fnv1a_(payload, fnv1a_(key)) != h.checksum)
+          break;
+
+        auto it = index_.find(std::string(key));
+        if (it != index_.end())
+          drop_locked_(it);
+
+        if (h.flags & k_flag_erase)
+        {
+          dead_bytes_ += size;
+        }
+        else
+        {
+          index_.emplace(std::string(key), Loc{off, size});
+          order_.emplace(off, std::string(key));
+          live_bytes_ += size;
+        }
+
+        off += size;
+      }
+
+      if (off < file_bytes_)
+      {
+        unmap_locked_();
+
+        std::error_code ec;
+        std::filesystem::resize_file(opt_.path, off, ec);
+        file_bytes_ = off;
+        flushed_bytes_ = off;
+      }
+
+      // Records superseded in the log already have their successors on disk.
+      unflushed_erasures_.clear();
+      stats_.recovered = index_.size();
+
+      while (live_bytes_ > opt_.max_bytes && !order_.empty())
+      {
+        erase_locked_(order_.begin()->second, false);
+        ++stats_.evictions;
+      }
+    }
+
+    /**
+     * @brief Create an empty cache file (truncating any existing one).
+     *
+     * Caller must hold mu_.
+     */
+    void reset_file_locked_()
+    {
+      index_.clear();
+      order_.clear();
+      unflushed_erasures_.clear();
+      live_bytes_ = 0;
+      dead_bytes_ = 0;
+      file_bytes_ = 0;
+
+      file_ = std::fopen(opt_.path.c_str(), "w+b");
+      if (!file_)
+        return;
+
+      if (std::fwrite(k_file_magic, 1, sizeof(k_file_magic), file_) != sizeof(k_file_magic) ||
+          std::fflush(file_) != 0)
+      {
+        close_locked_();
+        return;
+      }
+
+      file_bytes_ = sizeof(k_file_magic);
+      flushed_bytes_ = file_bytes_;
+      at_end_ = true;
+    }
+
+    /**
+     * @brief Append a record at the end of the log.
+     *
+     * Indexes it as a live entry unless it is a tombstone (@p key empty).
+     * The record stays in the stdio buffer until flush_bytes are pending.
+     *
+     * Caller must hold mu_.
+     */
+    bool append_locked_(const std::string &key, const std::string &rec)
+    {
+      const std::uint64_t off = file_bytes_;
+
+      // Seeking writes the stdio buffer out, so only seek after a read
+      // moved the file position.
+      if ((!at_end_ && !seek_(file_, off)) ||
+          std::fwrite(rec.data(), 1, rec.size(), file_) != rec.size())
+      {
+        rollback_locked_();
+        return false;
+      }
+
+      at_end_ = true;
+      file_bytes_ += rec.size();
+
+      if (key.empty())
+      {
+        dead_bytes_ += rec.size();
+        return true;
+      }
+
+      index_[key] = Loc{off, rec.size()};
+      order_.emplace(off, key);
+      live_bytes_ += rec.size();
+
+      if (file_bytes_ - flushed_bytes_ >= opt_.flush_bytes)
+        return flush_locked_();
+      return true;
+    }
+
+    /**
+     * @brief Write buffered records out to the file.
+     *
+     * Caller must hold mu_.
+     */
+    bool flush_locked_()
+    {
+      if (flushed_bytes_ != file_bytes_ && std::fflush(file_) != 0)
+      {
+        rollback_locked_();
+        return false;
+      }
+
+      flushed_bytes_ = file_bytes_;
+      unflushed_erasures_.clear();
+      return true;
+    }
+
+    /**
+     * @brief Drop every record appended since the last successful flush.
+     *
+     * Reopens the file so no stale buffered bytes reach it later, then
+     * truncates it back to the flushed size. Flushed records that were
+     * erased or overwritten in the meantime lost their tombstones with
+     * the truncation; those are written again so a restart does not
+     * revive them. If that fails too, the file is reset.
+     *
+     * Caller must hold mu_.
+     */
+    void rollback_locked_()
+    {
+      const std::uint64_t keep = flushed_bytes_;
+
+      close_locked_();
+
+      std::error_code ec;
+      std::filesystem::resize_file(opt_.path, keep, ec);
+      file_ = std::fopen(opt_.path.c_str(), "r+b");
+
+      for (auto it = order_.lower_bound(keep); it != order_.end();)
+      {
+        auto ii = index_.find(it->second);
+        live_bytes_ -= ii->second.size;
+        index_.erase(ii);
+        it = order_.erase(it);
+      }
+
+      file_bytes_ = keep;
+      at_end_ = false;
+
+      std::string tombstones;
+      for (const auto &k : unflushed_erasures_)
+      {
+        if (index_.find(k) == index_.end())
+          tombstones += encode_(k, nullptr);
+      }
+      unflushed_erasures_.clear();
+
+      if (file_ && !tombstones.empty())
+      {
+        if (seek_(file_, keep) &&
+            std::fwrite(tombstones.data(), 1, tombstones.size(), file_) == tombstones.size() &&
+            std::fflush(file_) == 0)
+        {
+          file_bytes_ += tombstones.size();
+          flushed_bytes_ = file_bytes_;
+          dead_bytes_ += tombstones.size();
+          at_end_ = true;
+          return;
+        }
+
+        // The erasures cannot be persisted: start empty rather than
+        // serve them again after a restart.
+        close_locked_();
+        reset_file_locked_();
+        return;
+      }
+
+      if (!file_)
+      {
+        // Nothing on disk may outlive what memory forgot.
+        std::filesystem::remove(opt_.path, ec);
+        index_.clear();
+        order_.clear();
+        live_bytes_ = 0;
+        dead_bytes_ = 0;
+        file_bytes_ = 0;
+        flushed_bytes_ = 0;
+      }
+    }
+
+    /**
+     * @brief Forget an indexed entry (its record becomes dead bytes).
+     *
+     * Caller must hold mu_.
+     */
+    void drop_locked_(Index::iterator it)
+    {
+      // A flushed record forgotten before its tombstone is flushed.
+      if (it->second.offset < flushed_bytes_)
+        unflushed_erasures_.push_back(it->first);
+
+      live_bytes_ -= it->second.size;
+      dead_bytes_ += it->second.size;
+      order_.erase(it->second.offset);
+      index_.erase(it);
+    }
+
+    /**
+     * @brief Drop an entry and persist the erasure with a tombstone.
+     *
+     * @param flush Write the tombstone out now. Explicit erasures (e.g.
+     * tag invalidation) must not come back after a crash; budget
+     * evictions may, so they ride along with the next batch.
+     *
+     * Caller must hold mu_.
+     */
+    void erase_locked_(std::string key, bool flush)
+    {
+      auto it = index_.find(key);
+      if (it == index_.end())
+        return;
+
+      const std::string rec = encode_(key, nullptr);
+      drop_locked_(it);
+
+      if (file_ && append_locked_({}, rec) && flush)
+        flush_locked_();
+    }
+
+    /**
+     * @brief Return a pointer to file bytes [offset, offset + size).
+     *
+     * Remaps when the range lies past the current mapping. Without mmap
+     * the bytes are read into a scratch buffer instead.
+     *
+     * Caller must hold mu_.
+     */
+    const char *read_locked_(std::uint64_t offset, std::size_t size)
+    {
+      if (!file_ || offset + size > file_bytes_)
+        return nullptr;
+
+      if (offset + size > flushed_bytes_ && !flush_locked_())
+        return nullptr;
+
+#if !defined(_WIN32)
+      if (offset + size > map_size_)
+      {
+        unmap_locked_();
+
+        // Map ahead of the file end so appends do not force a remap on
+        // every read. Pages past EOF are never touched.
+        const std::size_t want = static_cast<std::size_t>(
+            std::max<std::uint64_t>(file_bytes_ * 2, 1024 * 1024));
+
+        void *p = ::mmap(nullptr, want, PROT_READ, MAP_SHARED, ::fileno(file_), 0);
+        if (p == MAP_FAILED)
+          return nullptr;
+
+        map_ = static_cast<const char *>(p);
+        map_size_ = want;
+      }
+
+      return map_ + offset;
+#else
+      scratch_.resize(size);
+      at_end_ = false;
+      if (!seek_(file_, offset) || std::fread(scratch_.data(), 1, size, file_) != size)
+        return nullptr;
+      return scratch_.data();
+#endif
+    }
+
+    /**
+     * @brief Caller must hold mu_.
+     */
+    void unmap_locked_()
+    {
+#if !defined(_WIN32)
+      if (map_)
+        ::munmap(const_cast<char *>(map_), map_size_);
+#endif
+      map_ = nullptr;
+      map_size_ = 0;
+    }
+
+    /**
+     * @brief Caller must hold mu_.
+     */
+    void close_locked_()
+    {
+      unmap_locked_();
+
+      if (file_)
+        std::fclose(file_);
+      file_ = nullptr;
+    }
+
+    /**
+     * @brief Caller must hold mu_.
+     */
+    void maybe_compact_locked_()
+    {
+      if (opt_.auto_compact && dead_bytes_ >= opt_.compact_min_bytes && dead_bytes_ > live_bytes_)
+        compact_locked_();
+    }
+
+    /**
+     * @brief Rewrite live records into a fresh file and swap it in.
+     *
+     * On any failure the current file is kept as is.
+     *
+     * Caller must hold mu_.
+     */
+    void compact_locked_()
+    {
+      if (!flush_locked_())
+        return;
+
+      const std::string tmp_path = opt_.path + ".compact";
+
+      std::FILE *out = std::fopen(tmp_path.c_str(), "wb");
+      if (!out)
+        return;
+
+      bool ok = std::fwrite(k_file_magic, 1, sizeof(k_file_magic), out) == sizeof(k_file_magic);
+
+      Index next;
+      std::map<std::uint64_t, std::string> next_order;
+      std::uint64_t off = sizeof(k_file_magic);
+
+      for (auto oi = order_.begin(); ok && oi != order_.end(); ++oi)
+      {
+        const Loc &loc = index_.at(oi->second);
+        const char *p = read_locked_(loc.offset, loc.size);
+
+        ok = p && std::fwrite(p, 1, loc.size, out) == loc.size;
+        next.emplace(oi->second, Loc{off, loc.size});
+        next_order.emplace(off, oi->second);
+        off += loc.size;
+      }
+
+      ok = std::fflush(out) == 0 && ok;
+      std::fclose(out);
+
+      std::error_code ec;
+      if (!ok)
+      {
+        std::filesystem::remove(tmp_path, ec);
+        return;
+      }
+
+      close_locked_();
+      std::filesystem::rename(tmp_path, opt_.path, ec);
+      if (ec)
+        std::filesystem::remove(tmp_path, ec);
+
+      file_ = std::fopen(opt_.path.c_str(), "r+b");
+      if (!file_)
+      {
+        index_.clear();
+        order_.clear();
+        live_bytes_ = 0;
+        dead_bytes_ = 0;
+        file_bytes_ = 0;
+        flushed_bytes_ = 0;
+        return;
+      }
+
+      at_end_ = false;
+      if (!ec)
+      {
+        index_ = std::move(next);
+        order_ = std::move(next_order);
+        dead_bytes_ = 0;
+        file_bytes_ = off;
+        flushed_bytes_ = off;
+        ++stats_.compactions;
+      }
+    }
+
+  private:
+    MmapStoreOptions opt_{};
+
+    mutable std::mutex mu_;
+    std::FILE *file_{nullptr};
+    std::uint64_t file_bytes_{0};
+    std::uint64_t flushed_bytes_{0};
+    bool at_end_{false};
+    std::vector<std::string> unflushed_erasures_{};
+
+    const char *map_{nullptr};
+    std::size_t map_size_{0};
+#if defined(_WIN32)
+    std::string scratch_{};
+#endif
+
+    Index index_{};
+    std::map<std::uint64_t, std::string> order_{};
+    std::size_t live_bytes_{0};
+    std::size_t dead_bytes_{0};
+    MmapStoreStats stats_{};
+  };
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_MMAP_STORE_HPP
@@ -0,0 +1,393 @@
+/**
+ *
+ *  @file private_cache.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_PRIVATE_CACHE_HPP
+#define VIX_MIDDLEWARE_CACHE_PRIVATE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <vix/cache/CacheEntry.hpp>
+
+#include <vix/middleware/cache/cache_usage.hpp>
+#include <vix/middleware/cache/entry_bytes.hpp>
+#include <vix/middleware/cache/shared_entry.hpp>
+
+namespace vix::http
+{
+  class Request;
+}
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Maps a request to its principal id ("" for anonymous).
+   *
+   * auth::request_principal() (vix/middleware/auth/principal.hpp) is the
+   * resolver for the jwt(), session() and api_key() middlewares.
+   */
+  using PrincipalResolver = std::function<std::string(vix::http::Request &)>;
+
+  /**
+   * @brief Options for PrivateCache.
+   */
+  struct PrivateCacheOptions
+  {
+    /**
+     * @brief Byte quota of each principal's partition (LRU within it).
+     */
+    std::size_t max_bytes_per_principal{1024 * 1024};
+
+    /**
+     * @brief Partitions kept before the least recently active one is dropped.
+     */
+    std::size_t max_principals{10'000};
+
+    /**
+     * @brief Entry lifetime in ms.
+     */
+    std::int64_t ttl_ms{30'000};
+
+    /**
+     * @brief Lock stripes, principals are spread over them.
+     */
+    std::size_t stripes{16};
+  };
+
+  /**
+   * @brief Counters exposed by PrivateCache.
+   */
+  struct PrivateCacheStats
+  {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t stores{0};
+    std::uint64_t evictions{0};          ///< entries dropped by a partition quota
+    std::uint64_t principals_evicted{0}; ///< partitions dropped by max_principals
+    std::size_t principals{0};
+  };
+
+  /**
+   * @brief Response cache partitioned by principal (user, session, API key).
+   *
+   * Each principal gets its own LRU partition with a byte quota, so one
+   * user can neither read another user's entries nor evict them. The
+   * number of partitions is bounded as well: the least recently active
+   * principal is dropped first.
+   *
+   * Thread-safe. Principals are spread over lock stripes, so concurrent
+   * users rarely contend.
+   */
+  class PrivateCache final : public ICacheUsage
+  {
+  public:
+    explicit PrivateCache(PrivateCacheOptions opt = {})
+        : opt_(opt),
+          stripes_(opt.stripes == 0 ? 1 : opt.stripes)
+    {
+      const std::size_t n = stripes_.size();
+      per_stripe_principals_ = (opt_.max_principals + n - 1) / n;
+      if (per_stripe_principals_ == 0)
+        per_stripe_principals_ = 1;
+    }
+
+    /**
+     * @brief Look up a principal's entry.
+     *
+     * @return The entry, or nullptr if absent or older than ttl_ms.
+     */
+    SharedEntry get(const std::string &principal, const std::string &key, std::int64_t now_ms)
+    {
+      Stripe &s = stripe_(principal);
+      std::lock_guard<std::mutex> lock(s.mu);
+
+      auto pit = s.partitions.find(principal);
+      if (pit == s.partitions.end())
+      {
+        ++s.misses;
+        return nullptr;
+      }
+
+      Partition &p = pit->second;
+      s.order.splice(s.order.begin(), s.order, p.pos);
+
+      auto it = p.index.find(key);
+      if (it == p.index.end())
+      {
+        ++s.misses;
+        return nullptr;
+      }
+
+      if (now_ms - it->second->entry->created_at_ms >= opt_.ttl_ms)
+      {
+        remove_locked_(s, p, it);
+        ++s.misses;
+        return nullptr;
+      }
+
+      p.lru.splice(p.lru.begin(), p.lru, it->second);
+      ++s.hits;
+      return it->second->entry;
+    }
+
+    /**
+     * @brief Store an entry in a principal's partition.
+     *
+     * @return false if the entry alone exceeds the quota.
+     */
+    bool put(const std::string &principal, const std::string &key, SharedEntry entry)
+    {
+      if (!entry || principal.empty())
+        return false;
+
+      const std::size_t bytes = entry_bytes(key, *entry);
+      if (bytes > opt_.max_bytes_per_principal)
+        return false;
+
+      Stripe &s = stripe_(principal);
+      std::lock_guard<std::mutex> lock(s.mu);
+
+      Partition &p = partition_locked_(s, principal);
+
+      auto it = p.index.find(key);
+      if (it != p.index.end())
+        remove_locked_(s, p, it);
+
+      while (!p.lru.empty() && p.bytes + bytes > opt_.max_bytes_per_principal)
+      {
+        remove_locked_(s, p, p.index.find(p.lru.back().key));
+        ++s.evictions;
+      }
+
+      p.lru.push_front(Node{key, std::move(entry), bytes});
+      p.index.emplace(key, p.lru.begin());
+      p.bytes += bytes;
+      s.bytes += bytes;
+      ++s.entries;
+      ++s.stores;
+      return true;
+    }
+
+    /**
+     * @brief Drop @p key from every principal's partition.
+     *
+     * Used by CacheTagIndex when a private key is invalidated. Walks every
+     * partition, one stripe lock at a time.
+     *
+     * @return Number of entries removed.
+     */
+    std::size_t erase(const std::string &key)
+    {
+      std::size_t removed = 0;
+
+      for (auto &s : stripes_)
+      {
+        std::lock_guard<std::mutex> lock(s.mu);
+        for (auto &[principal, p] : s.partitions)
+        {
+          auto it = p.index.find(key);
+          if (it == p.index.end())
+            continue;
+
+          remove_locked_(s, p, it);
+          ++removed;
+        }
+      }
+
+      return removed;
+    }
+
+    /**
+     * @brief Drop every entry of a principal (e.g. on logout).
+     */
+    void erase_principal(const std::string &principal)
+    {
+      Stripe &s = stripe_(principal);
+      std::lock_guard<std::mutex> lock(s.mu);
+
+      auto pit = s.partitions.find(principal);
+      if (pit != s.partitions.end())
+        drop_partition_locked_(s, pit);
+    }
+
+    /** @brief Drop everything. */
+    void clear()
+    {
+      for (auto &s : stripes_)
+      {
+        std::lock_guard<std::mutex> lock(s.mu);
+        s.partitions.clear();
+        s.order.clear();
+        s.bytes = 0;
+        s.entries = 0;
+      }
+    }
+
+    CacheUsage usage() const override
+    {
+      CacheUsage u;
+      for (const auto &s : stripes_)
+      {
+        std::lock_guard<std::mutex> lock(s.mu);
+        u.bytes += s.bytes;
+        u.entries += s.entries;
+        u.evictions += s.evictions;
+      }
+      return u;
+    }
+
+    /** @brief Snapshot of counters. */
+    PrivateCacheStats stats() const
+    {
+      PrivateCacheStats st;
+      for (const auto &s : stripes_)
+      {
+        std::lock_guard<std::mutex> lock(s.mu);
+        st.hits += s.hits;
+        st.misses += s.misses;
+        st.stores += s.stores;
+        st.evictions += s.evictions;
+        st.principals_evicted += s.principals_evicted;
+        st.principals += s.partitions.size();
+      }
+      return st;
+    }
+
+    /** @brief Bytes held by one principal. */
+    std::size_t principal_bytes(const std::string &principal) const
+    {
+      const Stripe &s = stripe_(principal);
+      std::lock_guard<std::mutex> lock(s.mu);
+
+      auto pit = s.partitions.find(principal);
+      return pit == s.partitions.end() ? 0 : pit->second.bytes;
+    }
+
+    const PrivateCacheOptions &options() const noexcept { return opt_; }
+
+  private:
+    struct Node
+    {
+      std::string key;
+      SharedEntry entry;
+      std::size_t bytes{0};
+    };
+
+    using Lru = std::list<Node>;
+
+    struct Partition
+    {
+      Lru lru{};
+      std::unordered_map<std::string, Lru::iterator> index{};
+      std::size_t bytes{0};
+      std::list<std::string>::iterator pos{};
+    };
+
+    struct alignas(64) Stripe
+    {
+      mutable std::mutex mu;
+      std::unordered_map<std::string, Partition> partitions;
+      std::list<std::string> order; // most recently active principal first
+      std::size_t bytes{0};
+      std::size_t entries{0};
+      std::uint64_t hits{0};
+      std::uint64_t misses{0};
+      std::uint64_t stores{0};
+      std::uint64_t evictions{0};
+      std::uint64_t principals_evicted{0};
+    };
+
+    Stripe &stripe_(const std::string &principal)
+    {
+      return stripes_[std::hash<std::string>{}(principal) % stripes_.size()];
+    }
+
+    const Stripe &stripe_(const std::string &principal) const
+    {
+      return stripes_[std::hash<std::string>{}(principal) % stripes_.size()];
+    }
+
+    /**
+     * @brief Find or create a partition, dropping the least recently
+     * active one when the stripe is full.
+     *
+     * Caller must hold s.mu.
+     */
+    Partition &partition_locked_(Stripe &s, const std::string &principal)
+    {
+      auto pit = s.partitions.find(principal);
+      if (pit != s.partitions.end())
+      {
+        s.order.splice(s.order.begin(), s.order, pit->second.pos);
+        return pit->second;
+      }
+
+      while (s.partitions.size() >= per_stripe_principals_ && !s.order.empty())
+      {
+        drop_partition_locked_(s, s.partitions.find(s.order.back()));
+        ++s.principals_evicted;
+      }
+
+      s.order.push_front(principal);
+      Partition &p = s.partitions[principal];
+      p.pos = s.order.begin();
+      return p;
+    }
+
+    /**
+     * @brief Remove one entry of a partition.
+     *
+     * Caller must hold s.mu.
+     */
+    void remove_locked_(
+        Stripe &s,
+        Partition &p,
+        std::unordered_map<std::string, Lru::iterator>::iterator it)
+    {
+      p.bytes -= it->second->bytes;
+      s.bytes -= it->second->bytes;
+      --s.entries;
+      p.lru.erase(it->second);
+      p.index.erase(it);
+    }
+
+    /**
+     * @brief Remove a whole partition.
+     *
+     * Caller must hold s.mu.
+     */
+    void drop_partition_locked_(
+        Stripe &s,
+        std::unordered_map<std::string, Partition>::iterator pit)
+    {
+      s.bytes -= pit->second.bytes;
+      s.entries -= pit->second.index.size();
+      s.order.erase(pit->second.pos);
+      s.partitions.erase(pit);
+    }
+
+  private:
+    PrivateCacheOptions opt_{};
+    std::vector<Stripe> stripes_;
+    std::size_t per_stripe_principals_{1};
+  };
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_PRIVATE_CACHE_HPP
@@ -0,0 +1,221 @@
+/**
+ *
+ *  @file query_key.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_QUERY_KEY_HPP
+#define VIX_MIDDLEWARE_CACHE_QUERY_KEY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief How the query string contributes to the cache key.
+   *
+   * All options are off by default: the raw query string is used as is.
+   */
+  struct QueryKeyOptions
+  {
+    /**
+     * @brief Sort parameters by name ("?b=2&a=1" keys like "?a=1&b=2").
+     *
+     * The sort is stable, so repeated names keep their relative order.
+     */
+    bool sort{false};
+
+    /**
+     * @brief Normalize percent-encoding (RFC 3986, section 6.2.2).
+     *
+     * Escapes of unreserved characters are decoded ("%7E" -> "~") and the
+     * remaining escapes use uppercase hex ("%2f" -> "%2F").
+     */
+    bool normalize_encoding{false};
+
+    /**
+     * @brief Parameters dropped from the key (deny-list).
+     *
+     * A trailing '*' matches a name prefix, e.g. "utm_*".
+     * See tracking_query_params().
+     */
+    std::vector<std::string> ignore{};
+
+    /**
+     * @brief When non-empty, only these parameters are kept (allow-list).
+     *
+     * Same matching rules as ignore. Applied before ignore.
+     */
+    std::vector<std::string> allow{};
+
+    /** @brief True if any canonicalization is configured. */
+    bool enabled() const noexcept
+    {
+      return sort || normalize_encoding || !ignore.empty() || !allow.empty();
+    }
+  };
+
+  /**
+   * @brief Common marketing and click-tracking parameters.
+   *
+   * Meant for QueryKeyOptions::ignore on public, cacheable routes.
+   */
+  inline std::vector<std::string> tracking_query_params()
+  {
+    return {"utm_*", "fbclid", "gclid", "dclid", "msclkid", "yclid",
+            "mc_cid", "mc_eid", "igshid", "_ga", "_gl", "ref_src"};
+  }
+
+  /** @brief Value of an ASCII hex digit, or -1. */
+  inline int hex_value(char c)
+  {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+  /** @brief RFC 3986 unreserved character. */
+  inline bool is_unreserved(char c)
+  {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~';
+  }
+
+  /**
+   * @brief Normalize percent-escapes in a query component.
+   *
+   * Malformed escapes are kept verbatim.
+   */
+  inline std::string normalize_percent_encoding(std::string_view in)
+  {
+    static constexpr char hex[] = "0123456789ABCDEF";
+
+    std::string out;
+    out.reserve(in.size());
+
+    for (std::size_t i = 0; i < in.size(); ++i)
+    {
+      const int hi = (in[i] == '%' && i + 2 < in.size()) ? hex_value(in[i + 1]) : -1;
+      const int lo = (hi >= 0) ? hex_value(in[i + 2]) : -1;
+
+      if (lo < 0)
+      {
+        out += in[i];
+        continue;
+      }
+
+      const char c = static_cast<char>(hi * 16 + lo);
+      if (is_unreserved(c))
+      {
+        out += c;
+      }
+      else
+      {
+        out += '%';
+        out += hex[hi];
+        out += hex[lo];
+      }
+      i += 2;
+    }
+
+    return out;
+  }
+
+  /**
+   * @brief Match a parameter name against a list ("name" or "prefix*").
+   */
+  inline bool query_name_matches(std::string_view name, const std::vector<std::string> &patterns)
+  {
+    for (const auto &p : patterns)
+    {
+      if (!p.empty() && p.back() == '*')
+      {
+        const std::string_view prefix(p.data(), p.size() - 1);
+        if (name.substr(0, prefix.size()) == prefix)
+          return true;
+      }
+      else if (name == p)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Canonicalize a raw query string (without '?') for cache keys.
+   *
+   * Empty parameters ("a=1&&b=2") are dropped. Names are matched against
+   * allow/ignore after escape normalization, so "utm%5Fsource" is caught
+   * by "utm_*" as well.
+   */
+  inline std::string canonicalize_query(std::string_view raw, const QueryKeyOptions &opt)
+  {
+    if (!opt.enabled() || raw.empty())
+      return std::string(raw);
+
+    const std::size_t raw_size = raw.size();
+    std::vector<std::pair<std::string, std::string_view>> params;
+
+    while (!raw.empty())
+    {
+      const std::size_t amp = raw.find('&');
+      const std::string_view part = raw.substr(0, amp);
+      raw = (amp == std::string_view::npos) ? std::string_view{} : raw.substr(amp + 1);
+
+      if (part.empty())
+        continue;
+
+      const std::size_t eq = part.find('=');
+      std::string name = normalize_percent_encoding(part.substr(0, eq));
+
+      if (!opt.allow.empty() && !query_name_matches(name, opt.allow))
+        continue;
+      if (query_name_matches(name, opt.ignore))
+        continue;
+
+      params.emplace_back(std::move(name), part);
+    }
+
+    if (opt.sort)
+    {
+      std::stable_sort(params.begin(), params.end(),
+                       [](const auto &a, const auto &b)
+                       { return a.first < b.first; });
+    }
+
+    std::string out;
+    out.reserve(raw_size);
+
+    for (const auto &[name, part] : params)
+    {
+      if (!out.empty())
+        out += '&';
+
+      if (opt.normalize_encoding)
+        out += normalize_percent_encoding(part);
+      else
+        out.append(part.data(), part.size());
+    }
+
+    return out;
+  }
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_QUERY_KEY_HPP
@@ -0,0 +1,47 @@
+/**
+ *
+ *  @file shared_entry.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_SHARED_ENTRY_HPP
+#define VIX_MIDDLEWARE_CACHE_SHARED_ENTRY_HPP
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <vix/cache/CacheEntry.hpp>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Immutable, refcounted cache entry.
+   *
+   * Once built, an entry is never mutated, so any number of readers may
+   * hold it while the store replaces or evicts the key. Handing one out
+   * costs a refcount increment; L1Cache and PrivateCache keep their
+   * entries this way. Replaying one still copies the body once, since
+   * vix::http::Response owns its body as a std::string.
+   */
+  using SharedEntry = std::shared_ptr<const vix::cache::CacheEntry>;
+
+  /**
+   * @brief Wrap an entry into a SharedEntry.
+   *
+   * Pass an rvalue to move the body in; an lvalue is copied.
+   */
+  inline SharedEntry make_shared_entry(vix::cache::CacheEntry e)
+  {
+    return std::make_shared<const vix::cache::CacheEntry>(std::move(e));
+  }
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_SHARED_ENTRY_HPP
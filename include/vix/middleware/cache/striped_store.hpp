@@ -0,0 +1,207 @@
+/**
+ *
+ *  @file striped_store.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_STRIPED_STORE_HPP
+#define VIX_MIDDLEWARE_CACHE_STRIPED_STORE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <vix/cache/CacheEntry.hpp>
+#include <vix/cache/CacheStore.hpp>
+
+#include <vix/middleware/cache/cache_usage.hpp>
+#include <vix/middleware/cache/entry_bytes.hpp>
+#include <vix/middleware/cache/shared_entry.hpp>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Options for StripedStore.
+   */
+  struct StripedStoreOptions
+  {
+    /**
+     * @brief Number of lock stripes (rounded up to a power of two).
+     *
+     * A few times the number of cores keeps writer collisions rare.
+     */
+    std::size_t stripes{64};
+  };
+
+  /**
+   * @brief Concurrent unbounded in-memory store (drop-in for MemoryStore).
+   *
+   * Keys are spread over independent stripes, each with its own
+   * reader/writer lock and hash map:
+   * - get(): shared lock on one stripe, so readers never block each other
+   *   and only wait for a writer of the same stripe
+   * - put() / erase(): exclusive lock on one stripe
+   * - entries are immutable SharedEntry values: get() copies one under
+   *   the shared lock (no refcount traffic), which only delays writers of
+   *   that stripe; get_shared() hands it out to direct callers without
+   *   copying (http_cache() reads through vix::cache::Cache, i.e. get())
+   *
+   * Stripes sit on separate cache lines to avoid false sharing.
+   */
+  class StripedStore final : public vix::cache::CacheStore,
+                             public ICacheUsage
+  {
+  public:
+    explicit StripedStore(StripedStoreOptions opt = {})
+        : stripes_(round_up_pow2_(opt.stripes)),
+          mask_(stripes_.size() - 1)
+    {
+    }
+
+    void put(const std::string &key, const vix::cache::CacheEntry &entry) override
+    {
+      put_shared(key, make_shared_entry(entry));
+    }
+
+    std::optional<vix::cache::CacheEntry> get(const std::string &key) override
+    {
+      const Stripe &s = stripe_(key);
+
+      std::shared_lock<std::shared_mutex> lock(s.mu);
+      auto it = s.map.find(key);
+      if (it == s.map.end())
+        return std::nullopt;
+      return *it->second;
+    }
+
+    /** @brief Insert or replace an entry without copying it. */
+    void put_shared(const std::string &key, SharedEntry entry)
+    {
+      if (!entry)
+        return;
+
+      const std::size_t bytes = entry_bytes(key, *entry);
+      Stripe &s = stripe_(key);
+      SharedEntry replaced; // released after the lock
+
+      std::unique_lock<std::shared_mutex> lock(s.mu);
+
+      auto it = s.map.find(key);
+      if (it != s.map.end())
+      {
+        s.bytes -= entry_bytes(key, *it->second);
+        replaced = std::exchange(it->second, std::move(entry));
+      }
+      else
+      {
+        s.map.emplace(key, std::move(entry));
+      }
+      s.bytes += bytes;
+    }
+
+    /** @brief Resident entry for @p key, or nullptr on miss. */
+    SharedEntry get_shared(const std::string &key)
+    {
+      const Stripe &s = stripe_(key);
+
+      std::shared_lock<std::shared_mutex> lock(s.mu);
+      auto it = s.map.find(key);
+      return it == s.map.end() ? nullptr : it->second;
+    }
+
+    void erase(const std::string &key) override
+    {
+      Stripe &s = stripe_(key);
+      SharedEntry dropped; // released after the lock
+
+      std::unique_lock<std::shared_mutex> lock(s.mu);
+      auto it = s.map.find(key);
+      if (it == s.map.end())
+        return;
+
+      s.bytes -= entry_bytes(key, *it->second);
+      dropped = std::move(it->second);
+      s.map.erase(it);
+    }
+
+    void clear() override
+    {
+      for (auto &s : stripes_)
+      {
+        std::unordered_map<std::string, SharedEntry> dropped;
+        {
+          std::unique_lock<std::shared_mutex> lock(s.mu);
+          dropped.swap(s.map);
+          s.bytes = 0;
+        }
+      }
+    }
+
+    CacheUsage usage() const override
+    {
+      CacheUsage u;
+      for (const auto &s : stripes_)
+      {
+        std::shared_lock<std::shared_mutex> lock(s.mu);
+        u.bytes += s.bytes;
+        u.entries += s.map.size();
+      }
+      return u;
+    }
+
+    /** @brief Number of resident entries. */
+    std::size_t size() const
+    {
+      return usage().entries;
+    }
+
+    /** @brief Number of lock stripes. */
+    std::size_t stripes() const noexcept { return stripes_.size(); }
+
+  private:
+    struct alignas(64) Stripe
+    {
+      mutable std::shared_mutex mu;
+      std::unordered_map<std::string, SharedEntry> map;
+      std::size_t bytes{0};
+    };
+
+    static std::size_t round_up_pow2_(std::size_t n)
+    {
+      std::size_t p = 1;
+      while (p < n)
+        p <<= 1;
+      return p;
+    }
+
+    Stripe &stripe_(const std::string &key)
+    {
+      return stripes_[std::hash<std::string>{}(key) & mask_];
+    }
+
+    const Stripe &stripe_(const std::string &key) const
+    {
+      return stripes_[std::hash<std::string>{}(key) & mask_];
+    }
+
+  private:
+    std::vector<Stripe> stripes_;
+    std::size_t mask_{0};
+  };
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_STRIPED_STORE_HPP
@@ -0,0 +1,518 @@
+/**
+ *
+ *  @file tag_index.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_TAG_INDEX_HPP
+#define VIX_MIDDLEWARE_CACHE_TAG_INDEX_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <vix/cache/CacheStore.hpp>
+
+#include <vix/middleware/cache/private_cache.hpp>
+#include <vix/middleware/middleware.hpp>
+#include <vix/middleware/utils/clock.hpp>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Surrogate keys attached to a response through request state.
+   *
+   * Handlers (or middleware) fill this and http_cache() indexes the stored
+   * entry under every tag. Equivalent to sending a Surrogate-Key header.
+   */
+  struct CacheTags
+  {
+    std::vector<std::string> tags{};
+  };
+
+  /**
+   * @brief Attach surrogate keys to the response being built for @p req.
+   *
+   * @param req Current request.
+   * @param tags Tags to add (appended to any already present).
+   */
+  inline void add_cache_tags(vix::middleware::Request &req, std::vector<std::string> tags)
+  {
+    if (auto *st = req.try_state<CacheTags>())
+    {
+      for (auto &t : tags)
+        st->tags.push_back(std::move(t));
+      return;
+    }
+
+    req.emplace_state<CacheTags>(CacheTags{std::move(tags)});
+  }
+
+  /**
+   * @brief Split a Surrogate-Key style header (space or comma separated).
+   */
+  inline std::vector<std::string> split_tags(std::string_view v)
+  {
+    std::vector<std::string> out;
+    std::size_t i = 0;
+
+    while (i < v.size())
+    {
+      while (i < v.size() && (v[i] == ' ' || v[i] == ',' || v[i] == '\t'))
+        ++i;
+
+      const std::size_t start = i;
+      while (i < v.size() && v[i] != ' ' && v[i] != ',' && v[i] != '\t')
+        ++i;
+
+      if (i > start)
+        out.emplace_back(v.substr(start, i - start));
+    }
+
+    return out;
+  }
+
+  inline constexpr std::string_view k_private_index_prefix = "private:";
+
+  /**
+   * @brief Index key of the per-principal entries stored under @p key.
+   *
+   * Private entries of every principal share one index record, kept apart
+   * from the shared entry of the same key.
+   */
+  inline std::string private_index_key(const std::string &key)
+  {
+    return std::string(k_private_index_prefix) + key;
+  }
+
+  /**
+   * @brief Index from surrogate tags and paths to cache keys.
+   *
+   * http_cache() records every stored key with its request path and tags.
+   * Invalidation then touches only the affected keys:
+   * - invalidate_tag(): hash lookup, O(keys under the tag)
+   * - invalidate_prefix(): ordered path index, O(log n + keys under the prefix)
+   *
+   * Invalidated keys are erased from the attached store (if any) and get a
+   * tombstone holding the invalidation time. An entry created at or before
+   * its tombstone is treated as a miss, which also covers responses that
+   * were in flight while the invalidation ran and stores that are not
+   * attached. Tombstones are dropped after tombstone_ttl_ms; keep that at
+   * least as long as the cache TTL when no store is attached.
+   *
+   * Per-principal entries are recorded with record_private() under
+   * private_index_key(); invalidating them erases the key from every
+   * partition of the attached PrivateCache.
+   *
+   * Records are dropped record_ttl_ms after they were last recorded, so
+   * keys the store evicted or expired do not pile up. Keep it at least as
+   * long as the cache TTL (plus any stale-if-error window): an entry that
+   * outlives its record can no longer be found by tag or prefix.
+   *
+   * Thread-safe (single mutex). is_invalidated() only locks when an
+   * invalidation happened after the entry was created.
+   */
+  class CacheTagIndex final
+  {
+  public:
+    /**
+     * @brief Construct an index.
+     *
+     * @param store Store to erase invalidated keys from (optional).
+     * @param tombstone_ttl_ms How long invalidation tombstones are kept.
+     * @param record_ttl_ms How long a recorded key stays indexed.
+     */
+    explicit CacheTagIndex(
+        std::shared_ptr<vix::cache::CacheStore> store = nullptr,
+        std::int64_t tombstone_ttl_ms = 10 * 60'000,
+        std::int64_t record_ttl_ms = 10 * 60'000)
+        : store_(std::move(store)),
+          tombstone_ttl_ms_(tombstone_ttl_ms),
+          record_ttl_ms_(record_ttl_ms)
+    {
+    }
+
+    /**
+     * @brief Attach the store invalidated keys are erased from.
+     */
+    void attach_store(std::shared_ptr<vix::cache::CacheStore> store)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      store_ = std::move(store);
+    }
+
+    /**
+     * @brief Attach the private cache invalidated private keys are erased from.
+     */
+    void attach_private_cache(std::shared_ptr<PrivateCache> cache)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      private_cache_ = std::move(cache);
+    }
+
+    /**
+     * @brief Record a stored key with its request path and tags.
+     *
+     * Replaces any previous record of the key. Refused when the key was
+     * invalidated at or after @p created_at_ms, i.e. the response was
+     * produced before the invalidation and must not be stored.
+     *
+     * @return true if the key was recorded and may be stored.
+     */
+    bool record(
+        const std::string &key,
+        const std::string &path,
+        std::vector<std::string> tags,
+        std::int64_t created_at_ms)
+    {
+      return record_(key, path, std::move(tags), created_at_ms, false);
+    }
+
+    /**
+     * @brief Record a per-principal entry stored under @p key.
+     *
+     * Indexed under private_index_key(@p key). Tags add up across
+     * principals (each user's response may carry its own), so
+     * invalidating any of them drops the key for everyone.
+     *
+     * @return true if the key was recorded and may be stored.
+     */
+    bool record_private(
+        const std::string &key,
+        const std::string &path,
+        std::vector<std::string> tags,
+        std::int64_t created_at_ms)
+    {
+      return record_(private_index_key(key), path, std::move(tags), created_at_ms, true);
+    }
+
+    /**
+     * @brief Register a key derived from @p key (e.g. an encoded variant).
+     *
+     * Derived keys are erased together with their base key.
+     */
+    void link(const std::string &key, const std::string &derived_key)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+
+      auto it = records_.find(key);
+      if (it == records_.end())
+        return;
+
+      auto &d = it->second.derived;
+      for (const auto &k : d)
+      {
+        if (k == derived_key)
+          return;
+      }
+      d.push_back(derived_key);
+    }
+
+    /**
+     * @brief Invalidate every key stored under @p tag.
+     *
+     * @return Number of invalidated keys.
+     */
+    std::size_t invalidate_tag(const std::string &tag)
+    {
+      std::vector<std::string> keys;
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+
+        auto it = by_tag_.find(tag);
+        if (it == by_tag_.end())
+          return 0;
+
+        keys.assign(it->second.begin(), it->second.end());
+      }
+
+      return invalidate_keys_(keys);
+    }
+
+    /**
+     * @brief Invalidate every key whose request path starts with @p prefix.
+     *
+     * @return Number of invalidated keys.
+     */
+    std::size_t invalidate_prefix(const std::string &prefix)
+    {
+      std::vector<std::string> keys;
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+
+        for (auto it = by_path_.lower_bound(prefix);
+             it != by_path_.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+             ++it)
+        {
+          keys.insert(keys.end(), it->second.begin(), it->second.end());
+        }
+      }
+
+      return invalidate_keys_(keys);
+    }
+
+    /**
+     * @brief Invalidate a single key, shared and per-principal entries.
+     */
+    std::size_t invalidate_key(const std::string &key)
+    {
+      return invalidate_keys_({key, private_index_key(key)});
+    }
+
+    /**
+     * @brief Check whether an entry created at @p created_at_ms was invalidated.
+     */
+    bool is_invalidated(const std::string &key, std::int64_t created_at_ms)
+    {
+      // No invalidation since the entry was created: nothing to look up.
+      if (generation() == 0 ||
+          created_at_ms > last_invalidation_ms_.load(std::memory_order_acquire))
+        return false;
+
+      std::lock_guard<std::mutex> lock(mu_);
+      prune_tombstones_locked_(vix::middleware::utils::Clock::now_ms_steady());
+
+      auto it = tombstones_.find(key);
+      return it != tombstones_.end() && created_at_ms <= it->second;
+    }
+
+    /**
+     * @brief Counter bumped by every invalidation.
+     *
+     * Lets lock-free caches in front of the store (e.g. L1Cache) drop their
+     * copies without calling is_invalidated() on every hit.
+     */
+    std::uint64_t generation() const noexcept
+    {
+      return generation_.load(std::memory_order_acquire);
+    }
+
+    /** @brief Number of indexed keys. */
+    std::size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return records_.size();
+    }
+
+  private:
+    struct Record
+    {
+      std::string path;
+      std::vector<std::string> tags;
+      std::vector<std::string> derived;
+      std::int64_t recorded_at_ms{0};
+    };
+
+    /**
+     * @brief Shared implementation of record() and record_private().
+     */
+    bool record_(
+        const std::string &key,
+        const std::string &path,
+        std::vector<std::string> tags,
+        std::int64_t created_at_ms,
+        bool merge_tags)
+    {
+      const std::int64_t now = vix::middleware::utils::Clock::now_ms_steady();
+
+      std::lock_guard<std::mutex> lock(mu_);
+      prune_records_locked_(now);
+
+      auto tomb = tombstones_.find(key);
+      if (tomb != tombstones_.end() && created_at_ms <= tomb->second)
+        return false;
+
+      std::vector<std::string> derived;
+      if (auto it = records_.find(key); merge_tags && it != records_.end())
+      {
+        for (auto &t : it->second.tags)
+        {
+          if (std::find(tags.begin(), tags.end(), t) == tags.end())
+            tags.push_back(std::move(t));
+        }
+        derived = std::move(it->second.derived);
+      }
+
+      unlink_locked_(key);
+
+      for (const auto &t : tags)
+        by_tag_[t].insert(key);
+      by_path_[path].insert(key);
+
+      records_[key] = Record{path, std::move(tags), std::move(derived), now};
+      record_order_.emplace_back(now, key);
+      return true;
+    }
+
+    /**
+     * @brief Tombstone and erase @p keys.
+     *
+     * Unindexed keys are tombstoned and erased from the store too (they
+     * may be in flight or stored without a record) but are not counted.
+     *
+     * @return Number of keys that were indexed.
+     */
+    std::size_t invalidate_keys_(const std::vector<std::string> &keys)
+    {
+      const std::int64_t now = vix::middleware::utils::Clock::now_ms_steady();
+
+      std::size_t removed = 0;
+      std::vector<std::string> erase;
+      std::shared_ptr<vix::cache::CacheStore> store;
+      std::shared_ptr<PrivateCache> private_cache;
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        prune_tombstones_locked_(now);
+        prune_records_locked_(now);
+
+        for (const auto &key : keys)
+        {
+          auto it = records_.find(key);
+          if (it != records_.end())
+          {
+            ++removed;
+            for (auto &d : it->second.derived)
+              erase.push_back(std::move(d));
+          }
+
+          unlink_locked_(key);
+          tombstones_[key] = now;
+          tombstone_order_.emplace_back(now, key);
+          erase.push_back(key);
+        }
+
+        store = store_;
+        private_cache = private_cache_;
+        last_invalidation_ms_.store(now, std::memory_order_release);
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+      }
+
+      for (const auto &k : erase)
+      {
+        const std::string_view sk(k);
+        if (sk.substr(0, k_private_index_prefix.size()) == k_private_index_prefix)
+        {
+          if (private_cache)
+            private_cache->erase(std::string(sk.substr(k_private_index_prefix.size())));
+        }
+        else if (store)
+        {
+          store->erase(k);
+        }
+      }
+
+      return removed;
+    }
+
+    /**
+     * @brief Drop a key from all indexes.
+     *
+     * Caller must hold mu_.
+     */
+    void unlink_locked_(const std::string &key)
+    {
+      auto it = records_.find(key);
+      if (it == records_.end())
+        return;
+
+      for (const auto &t : it->second.tags)
+      {
+        auto ti = by_tag_.find(t);
+        if (ti == by_tag_.end())
+          continue;
+
+        ti->second.erase(key);
+        if (ti->second.empty())
+          by_tag_.erase(ti);
+      }
+
+      auto pi = by_path_.find(it->second.path);
+      if (pi != by_path_.end())
+      {
+        pi->second.erase(key);
+        if (pi->second.empty())
+          by_path_.erase(pi);
+      }
+
+      records_.erase(it);
+    }
+
+    /**
+     * @brief Drop tombstones older than tombstone_ttl_ms (amortized O(1)).
+     *
+     * Caller must hold mu_.
+     */
+    void prune_tombstones_locked_(std::int64_t now)
+    {
+      while (!tombstone_order_.empty() &&
+             now - tombstone_order_.front().first > tombstone_ttl_ms_)
+      {
+        const auto &[t, key] = tombstone_order_.front();
+
+        auto it = tombstones_.find(key);
+        if (it != tombstones_.end() && it->second == t)
+          tombstones_.erase(it);
+
+        tombstone_order_.pop_front();
+      }
+    }
+
+    /**
+     * @brief Drop records not re-recorded within record_ttl_ms (amortized O(1)).
+     *
+     * Caller must hold mu_.
+     */
+    void prune_records_locked_(std::int64_t now)
+    {
+      while (!record_order_.empty() &&
+             now - record_order_.front().first > record_ttl_ms_)
+      {
+        const auto &[t, key] = record_order_.front();
+
+        auto it = records_.find(key);
+        if (it != records_.end() && it->second.recorded_at_ms == t)
+          unlink_locked_(key);
+
+        record_order_.pop_front();
+      }
+    }
+
+  private:
+    mutable std::mutex mu_;
+    std::shared_ptr<vix::cache::CacheStore> store_{};
+    std::shared_ptr<PrivateCache> private_cache_{};
+    std::int64_t tombstone_ttl_ms_{10 * 60'000};
+    std::int64_t record_ttl_ms_{10 * 60'000};
+
+    std::unordered_map<std::string, Record> records_{};
+    std::unordered_map<std::string, std::unordered_set<std::string>> by_tag_{};
+    std::map<std::string, std::unordered_set<std::string>> by_path_{};
+
+    std::unordered_map<std::string, std::int64_t> tombstones_{};
+    std::deque<std::pair<std::int64_t, std::string>> tombstone_order_{};
+    std::deque<std::pair<std::int64_t, std::string>> record_order_{};
+
+    std::atomic<std::int64_t> last_invalidation_ms_{0};
+    std::atomic<std::uint64_t> generation_{0};
+  };
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_TAG_INDEX_HPP
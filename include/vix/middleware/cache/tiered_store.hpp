@@ -0,0 +1,157 @@
+/**
+ *
+ *  @file tiered_store.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_TIERED_STORE_HPP
+#define VIX_MIDDLEWARE_CACHE_TIERED_STORE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <vix/cache/CacheEntry.hpp>
+#include <vix/cache/CacheStore.hpp>
+
+#include <vix/middleware/cache/cache_usage.hpp>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Counters exposed by TieredStore.
+   */
+  struct TieredStoreStats
+  {
+    std::uint64_t hot_hits{0};
+    std::uint64_t cold_hits{0};
+    std::uint64_t misses{0};
+  };
+
+  /**
+   * @brief Two-level cache store: a memory tier in front of a disk tier.
+   *
+   * - get(): the hot tier is checked first; a cold hit is promoted into
+   *   the hot tier so the next lookup stays in memory
+   * - put(): written to both tiers, so the cold tier always holds every
+   *   entry and a restarted process is warm from its first request
+   * - an entry evicted from a bounded hot tier (e.g. TinyLfuStore) is
+   *   thereby demoted to disk rather than lost
+   *
+   * Typical setup: TinyLfuStore (hot) + MmapStore (cold). usage() reports
+   * the memory tier when it can, the disk tier otherwise. Thread safety is
+   * that of the underlying stores.
+   *
+   * Both tiers are written on the caller's thread, so a cache miss pays
+   * for the cold put as well. With MmapStore that is an encode plus a
+   * buffered append under its mutex; the write(2) itself is batched (see
+   * MmapStoreOptions::flush_bytes). A bounded hot tier keeps the memory
+   * footprint fixed while the disk tier grows up to its own budget.
+   */
+  class TieredStore final : public vix::cache::CacheStore,
+                            public ICacheUsage
+  {
+  public:
+    TieredStore(std::shared_ptr<vix::cache::CacheStore> hot,
+                std::shared_ptr<vix::cache::CacheStore> cold)
+        : hot_(std::move(hot)),
+          cold_(std::move(cold))
+    {
+    }
+
+    void put(const std::string &key, const vix::cache::CacheEntry &entry) override
+    {
+      if (hot_)
+        hot_->put(key, entry);
+      if (cold_)
+        cold_->put(key, entry);
+    }
+
+    std::optional<vix::cache::CacheEntry> get(const std::string &key) override
+    {
+      if (hot_)
+      {
+        if (auto e = hot_->get(key))
+        {
+          hot_hits_.fetch_add(1, std::memory_order_relaxed);
+          return e;
+        }
+      }
+
+      if (cold_)
+      {
+        if (auto e = cold_->get(key))
+        {
+          cold_hits_.fetch_add(1, std::memory_order_relaxed);
+          if (hot_)
+            hot_->put(key, *e);
+          return e;
+        }
+      }
+
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+
+    void erase(const std::string &key) override
+    {
+      if (hot_)
+        hot_->erase(key);
+      if (cold_)
+        cold_->erase(key);
+    }
+
+    void clear() override
+    {
+      if (hot_)
+        hot_->clear();
+      if (cold_)
+        cold_->clear();
+    }
+
+    CacheUsage usage() const override
+    {
+      if (auto *u = dynamic_cast<const ICacheUsage *>(hot_.get()))
+        return u->usage();
+      if (auto *u = dynamic_cast<const ICacheUsage *>(cold_.get()))
+        return u->usage();
+      return {};
+    }
+
+    /** @brief Snapshot of tier hit counters. */
+    TieredStoreStats stats() const
+    {
+      TieredStoreStats s;
+      s.hot_hits = hot_hits_.load(std::memory_order_relaxed);
+      s.cold_hits = cold_hits_.load(std::memory_order_relaxed);
+      s.misses = misses_.load(std::memory_order_relaxed);
+      return s;
+    }
+
+    /** @brief Memory tier. */
+    const std::shared_ptr<vix::cache::CacheStore> &hot() const noexcept { return hot_; }
+
+    /** @brief Disk tier. */
+    const std::shared_ptr<vix::cache::CacheStore> &cold() const noexcept { return cold_; }
+
+  private:
+    std::shared_ptr<vix::cache::CacheStore> hot_;
+    std::shared_ptr<vix::cache::CacheStore> cold_;
+
+    std::atomic<std::uint64_t> hot_hits_{0};
+    std::atomic<std::uint64_t> cold_hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+  };
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_TIERED_STORE_HPP
@@ -0,0 +1,310 @@
+/**
+ *
+ *  @file tinylfu_store.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_TINYLFU_STORE_HPP
+#define VIX_MIDDLEWARE_CACHE_TINYLFU_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <vix/cache/CacheEntry.hpp>
+#include <vix/cache/CacheStore.hpp>
+
+#include <vix/middleware/cache/cache_usage.hpp>
+#include <vix/middleware/cache/entry_bytes.hpp>
+#include <vix/middleware/cache/frequency_sketch.hpp>
+#include <vix/middleware/cache/shared_entry.hpp>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Configuration options for TinyLfuStore.
+   */
+  struct TinyLfuOptions
+  {
+    /**
+     * @brief Byte budget for resident entries (key + body + headers + overhead).
+     */
+    std::size_t max_bytes{64 * 1024 * 1024};
+
+    /**
+     * @brief Expected number of resident entries, used to size the sketch.
+     *
+     * A rough order of magnitude is enough. Too small a value makes
+     * frequency estimates noisier, too large wastes a little memory.
+     */
+    std::size_t expected_entries{16 * 1024};
+  };
+
+  /**
+   * @brief Counters exposed by TinyLfuStore.
+   */
+  struct TinyLfuStats
+  {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t admitted{0};
+    std::uint64_t rejected{0};
+    std::uint64_t evictions{0};
+    std::size_t bytes{0};
+    std::size_t entries{0};
+  };
+
+  /**
+   * @brief Byte-bounded cache store with TinyLFU admission.
+   *
+   * Drop-in vix::cache::CacheStore for vix::cache::Cache:
+   * - resident entries are bounded by a byte budget, not an entry count
+   * - every lookup (hit or miss) is recorded in a FrequencySketch
+   * - when a new entry does not fit, victims are taken from the LRU tail
+   *   until enough bytes are free; the entry is admitted only if its
+   *   estimated frequency beats the combined frequency of those victims
+   *
+   * One-off keys (random query strings, scans) therefore cannot push out
+   * hot entries, and a large body has to be more popular than everything
+   * it would displace. Updates of a resident key are always accepted.
+   *
+   * Entries are held as immutable SharedEntry values, so get() copies a
+   * body outside the lock; get_shared() and put_shared() let direct
+   * callers skip that copy.
+   *
+   * Thread-safe (single mutex).
+   */
+  class TinyLfuStore final : public vix::cache::CacheStore,
+                             public ICacheUsage
+  {
+  public:
+    explicit TinyLfuStore(TinyLfuOptions opt = {})
+        : opt_(opt),
+          sketch_(opt.expected_entries)
+    {
+    }
+
+    void put(const std::string &key, const vix::cache::CacheEntry &entry) override
+    {
+      put_shared(key, make_shared_entry(entry));
+    }
+
+    std::optional<vix::cache::CacheEntry> get(const std::string &key) override
+    {
+      if (auto e = get_shared(key))
+        return *e;
+      return std::nullopt;
+    }
+
+    /** @brief Insert or replace an entry without copying it. */
+    void put_shared(const std::string &key, SharedEntry entry)
+    {
+      if (!entry)
+        return;
+
+      const std::size_t bytes = entry_bytes(key, *entry);
+      const std::uint64_t h = hash_(key);
+
+      std::lock_guard<std::mutex> lock(mu_);
+
+      auto it = index_.find(key);
+      if (it != index_.end())
+      {
+        if (bytes > opt_.max_bytes)
+        {
+          remove_locked_(it);
+          ++stats_.rejected;
+          return;
+        }
+
+        auto node = it->second;
+        bytes_ = bytes_ - node->bytes + bytes;
+        node->entry = std::move(entry);
+        node->bytes = bytes;
+        lru_.splice(lru_.begin(), lru_, node);
+
+        while (bytes_ > opt_.max_bytes && std::prev(lru_.end()) != node)
+          evict_back_locked_();
+        return;
+      }
+
+      if (bytes > opt_.max_bytes)
+      {
+        ++stats_.rejected;
+        return;
+      }
+
+      if (bytes_ + bytes > opt_.max_bytes)
+      {
+        std::size_t freed = 0;
+        std::size_t victims = 0;
+        std::uint32_t victims_freq = 0;
+
+        for (auto v = lru_.rbegin();
+             v != lru_.rend() && bytes_ - freed + bytes > opt_.max_bytes;
+             ++v)
+        {
+          freed += v->bytes;
+          victims_freq += sketch_.estimate(v->hash);
+          ++victims;
+        }
+
+        if (sketch_.estimate(h) <= victims_freq)
+        {
+          ++stats_.rejected;
+          return;
+        }
+
+        while (victims-- > 0)
+          evict_back_locked_();
+      }
+
+      lru_.push_front(Node{key, std::move(entry), bytes, h});
+      index_.emplace(key, lru_.begin());
+      bytes_ += bytes;
+      ++stats_.admitted;
+    }
+
+    /** @brief Resident entry for @p key, or nullptr on miss. */
+    SharedEntry get_shared(const std::string &key)
+    {
+      const std::uint64_t h = hash_(key);
+
+      std::lock_guard<std::mutex> lock(mu_);
+      sketch_.increment(h);
+
+      auto it = index_.find(key);
+      if (it == index_.end())
+      {
+        ++stats_.misses;
+        return nullptr;
+      }
+
+      ++stats_.hits;
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return it->second->entry;
+    }
+
+    void erase(const std::string &key) override
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+
+      auto it = index_.find(key);
+      if (it != index_.end())
+        remove_locked_(it);
+    }
+
+    void clear() override
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      lru_.clear();
+      index_.clear();
+      bytes_ = 0;
+    }
+
+    /** @brief Snapshot of store counters. */
+    TinyLfuStats stats() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      TinyLfuStats s = stats_;
+      s.bytes = bytes_;
+      s.entries = index_.size();
+      return s;
+    }
+
+    CacheUsage usage() const override
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return CacheUsage{bytes_, index_.size(), stats_.evictions};
+    }
+
+    /** @brief Bytes currently charged to the budget. */
+    std::size_t bytes() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return bytes_;
+    }
+
+    /** @brief Number of resident entries. */
+    std::size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return index_.size();
+    }
+
+    /** @brief Configured byte budget. */
+    std::size_t max_bytes() const noexcept { return opt_.max_bytes; }
+
+  private:
+    struct Node
+    {
+      std::string key;
+      SharedEntry entry;
+      std::size_t bytes{0};
+      std::uint64_t hash{0};
+    };
+
+    using List = std::list<Node>;
+    using Index = std::unordered_map<std::string, List::iterator>;
+
+    static std::uint64_t hash_(const std::string &key)
+    {
+      return static_cast<std::uint64_t>(std::hash<std::string>{}(key));
+    }
+
+    /**
+     * @brief Remove the least recently used entry.
+     *
+     * Caller must hold mu_.
+     */
+    void evict_back_locked_()
+    {
+      if (lru_.empty())
+        return;
+
+      auto &n = lru_.back();
+      bytes_ -= n.bytes;
+      index_.erase(n.key);
+      lru_.pop_back();
+      ++stats_.evictions;
+    }
+
+    /**
+     * @brief Remove an indexed entry.
+     *
+     * Caller must hold mu_.
+     */
+    void remove_locked_(Index::iterator it)
+    {
+      bytes_ -= it->second->bytes;
+      lru_.erase(it->second);
+      index_.erase(it);
+    }
+
+  private:
+    TinyLfuOptions opt_{};
+
+    mutable std::mutex mu_;
+    FrequencySketch sketch_;
+    List lru_{};
+    Index index_{};
+    std::size_t bytes_{0};
+    TinyLfuStats stats_{};
+  };
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_TINYLFU_STORE_HPP
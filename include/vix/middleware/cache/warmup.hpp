@@ -0,0 +1,238 @@
+/**
+ *
+ *  @file warmup.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_CACHE_WARMUP_HPP
+#define VIX_MIDDLEWARE_CACHE_WARMUP_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <vix/middleware/observability/metrics.hpp>
+#include <vix/middleware/utils/clock.hpp>
+
+namespace vix::middleware::cache
+{
+  /**
+   * @brief Progress of a cache warm-up run.
+   */
+  struct WarmupReport
+  {
+    std::size_t total{0};
+    std::size_t done{0};
+    std::size_t ok{0};     ///< replayed with a 2xx status
+    std::size_t failed{0}; ///< non-2xx status or exception
+    std::int64_t elapsed_ms{0};
+  };
+
+  /**
+   * @brief Options for warm_cache().
+   */
+  struct WarmupOptions
+  {
+    /**
+     * @brief Number of worker threads (bounded by the number of targets).
+     */
+    std::size_t concurrency{4};
+
+    /**
+     * @brief Sink for progress metrics (optional).
+     *
+     * Receives <prefix>_targets, <prefix>_done and <prefix>_progress_ratio
+     * gauges plus <prefix>_ok_total / <prefix>_failed_total counters, and
+     * the run duration as a <prefix>_duration_ms observation.
+     */
+    std::shared_ptr<vix::middleware::observability::IMetricsSink> metrics{};
+    std::string metrics_prefix{"vix_http_cache_warmup"};
+
+    /**
+     * @brief Called after each target (optional, serialized).
+     *
+     * Runs on a worker thread; exceptions it throws are swallowed so the
+     * run always completes.
+     */
+    std::function<void(const WarmupReport &)> on_progress{};
+  };
+
+  /**
+   * @brief Replay one GET target through the pipeline.
+   *
+   * Returns the response status; exceptions count as failures.
+   */
+  using WarmupFetch = std::function<int(const std::string &target)>;
+
+  /**
+   * @brief Parse a warm-up manifest: one target per line.
+   *
+   * Blank lines and lines starting with '#' are skipped. Targets are
+   * origin-form ("/api/products?page=1"); lines not starting with '/'
+   * are ignored.
+   */
+  inline std::vector<std::string> parse_warmup_manifest(std::string_view text)
+  {
+    std::vector<std::string> out;
+
+    while (!text.empty())
+    {
+      const std::size_t nl = text.find('\n');
+      std::string_view line = text.substr(0, nl);
+      text = (nl == std::string_view::npos) ? std::string_view{} : text.substr(nl + 1);
+
+      while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+        line.remove_prefix(1);
+      while (!line.empty() && (line.back() == ' ' || line.back() == '\t' || line.back() == '\r'))
+        line.remove_suffix(1);
+
+      if (line.empty() || line.front() != '/')
+        continue;
+
+      out.emplace_back(line);
+    }
+
+    return out;
+  }
+
+  /**
+   * @brief Read a warm-up manifest file (see parse_warmup_manifest()).
+   *
+   * A missing or unreadable file yields no targets.
+   */
+  inline std::vector<std::string> read_warmup_manifest(const std::string &path)
+  {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+      return {};
+
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return parse_warmup_manifest(text);
+  }
+
+  /**
+   * @brief Replay GET targets on a bounded worker pool to fill the cache.
+   *
+   * Blocks until every target was replayed, so it can run before the node
+   * reports ready. Workers pull targets from a shared cursor; the order of
+   * the manifest is roughly the order of replay, so put the hottest
+   * targets first.
+   *
+   * @param targets Targets to replay.
+   * @param fetch Replays one target and returns its status.
+   * @param opt Pool size and progress reporting.
+   * @return Final report.
+   */
+  inline WarmupReport warm_cache(
+      const std::vector<std::string> &targets,
+      const WarmupFetch &fetch,
+      const WarmupOptions &opt = {})
+  {
+    namespace obs = vix::middleware::observability;
+
+    WarmupReport report;
+    report.total = targets.size();
+
+    if (targets.empty() || !fetch)
+      return report;
+
+    const std::int64_t started = vix::middleware::utils::Clock::now_ms_steady();
+    const std::string &p = opt.metrics_prefix;
+    obs::IMetricsSink *sink = opt.metrics.get();
+
+    if (sink)
+    {
+      sink->set_gauge(p + "_targets", static_cast<double>(report.total));
+      sink->set_gauge(p + "_done", 0.0);
+      sink->set_gauge(p + "_progress_ratio", 0.0);
+    }
+
+    std::atomic<std::size_t> cursor{0};
+    std::mutex mu;
+
+    auto worker = [&]()
+    {
+      for (;;)
+      {
+        const std::size_t i = cursor.fetch_add(1, std::memory_order_relaxed);
+        if (i >= targets.size())
+          return;
+
+        bool ok = false;
+        try
+        {
+          const int status = fetch(targets[i]);
+          ok = status >= 200 && status < 300;
+        }
+        catch (...)
+        {
+          ok = false;
+        }
+
+        std::lock_guard<std::mutex> lock(mu);
+        report.done++;
+        if (ok)
+          report.ok++;
+        else
+          report.failed++;
+
+        if (sink)
+        {
+          sink->inc_counter(ok ? p + "_ok_total" : p + "_failed_total");
+          sink->set_gauge(p + "_done", static_cast<double>(report.done));
+          sink->set_gauge(p + "_progress_ratio",
+                          static_cast<double>(report.done) / static_cast<double>(report.total));
+        }
+
+        if (opt.on_progress)
+        {
+          try
+          {
+            opt.on_progress(report);
+          }
+          catch (...)
+          {
+          }
+        }
+      }
+    };
+
+    const std::size_t n = std::max<std::size_t>(1, std::min(opt.concurrency, targets.size()));
+
+    std::vector<std::thread> pool;
+    pool.reserve(n - 1);
+    for (std::size_t t = 1; t < n; ++t)
+      pool.emplace_back(worker);
+
+    worker();
+
+    for (auto &t : pool)
+      t.join();
+
+    report.elapsed_ms = vix::middleware::utils::Clock::now_ms_steady() - started;
+
+    if (sink)
+      sink->observe_ms(p + "_duration_ms", static_cast<double>(report.elapsed_ms));
+
+    return report;
+  }
+
+} // namespace vix::middleware::cache
+
+#endif // VIX_MIDDLEWARE_CACHE_WARMUP_HPP
@@ -0,0 +1,302 @@
+/**
+ *
+ *  @file range.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_MIDDLEWARE_HTTP_RANGE_HPP
+#define VIX_MIDDLEWARE_HTTP_RANGE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <vix/middleware/utils/clock.hpp>
+
+namespace vix::middleware::range
+{
+  /**
+   * @brief Inclusive byte range [first, last] within a representation.
+   */
+  struct ByteRange
+  {
+    std::size_t first{0};
+    std::size_t last{0};
+
+    std::size_t length() const noexcept { return last - first + 1; }
+  };
+
+  /**
+   * @brief Outcome of parsing a Range header against a body size.
+   */
+  enum class RangeStatus
+  {
+    Ignore,        ///< absent, malformed or not worth honoring: send 200
+    Satisfiable,   ///< at least one range overlaps the body: send 206
+    Unsatisfiable, ///< no range overlaps the body: send 416
+  };
+
+  /**
+   * @brief Parsed Range header.
+   */
+  struct RangeSet
+  {
+    RangeStatus status{RangeStatus::Ignore};
+    std::vector<ByteRange> ranges{};
+  };
+
+  /** @brief Parse an unsigned decimal, saturating on overflow. */
+  inline bool parse_size(std::string_view s, std::size_t &out)
+  {
+    if (s.empty())
+      return false;
+
+    std::size_t v = 0;
+    for (char c : s)
+    {
+      if (c < '0' || c > '9')
+        return false;
+
+      const std::size_t d = static_cast<std::size_t>(c - '0');
+      if (v > (std::numeric_limits<std::size_t>::max() - d) / 10)
+        v = std::numeric_limits<std::size_t>::max();
+      else
+        v = v * 10 + d;
+    }
+
+    out = v;
+    return true;
+  }
+
+  /** @brief Trim spaces and tabs from both ends. */
+  inline std::string_view trim_ows(std::string_view s)
+  {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+      s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+      s.remove_suffix(1);
+    return s;
+  }
+
+  /**
+   * @brief Parse a "Range: bytes=..." header (RFC 9110, section 14.2).
+   *
+   * Supports "a-b", "a-" and suffix "-n" specs. Ranges that do not overlap
+   * the body are dropped; overlapping or adjacent ranges are coalesced so a
+   * client cannot make the server send more than the body size.
+   *
+   * @param header Range header value.
+   * @param size Size of the full body.
+   * @param max_ranges Above this many specs the header is ignored.
+   */
+  inline RangeSet parse_range(std::string_view header, std::size_t size, std::size_t max_ranges = 16)
+  {
+    RangeSet out;
+
+    header = trim_ows(header);
+    const std::size_t eq = header.find('=');
+    if (eq == std::string_view::npos)
+      return out;
+
+    std::string_view unit = trim_ows(header.substr(0, eq));
+    if (unit.size() != 5)
+      return out;
+    for (std::size_t i = 0; i < 5; ++i)
+    {
+      if (std::tolower(static_cast<unsigned char>(unit[i])) != "bytes"[i])
+        return out;
+    }
+
+    std::vector<ByteRange> ranges;
+    std::size_t specs = 0;
+    std::string_view rest = header.substr(eq + 1);
+
+    while (!rest.empty())
+    {
+      const std::size_t comma = rest.find(',');
+      std::string_view spec = trim_ows(rest.substr(0, comma));
+      rest = (comma == std::string_view::npos) ? std::string_view{} : rest.substr(comma + 1);
+
+      if (spec.empty())
+        continue;
+
+      if (++specs > max_ranges)
+        return out;
+
+      const std::size_t dash = spec.find('-');
+      if (dash == std::string_view::npos)
+        return out;
+
+      const std::string_view a = spec.substr(0, dash);
+      const std::string_view b = spec.substr(dash + 1);
+
+      if (a.empty())
+      {
+        std::size_t n = 0;
+        if (!parse_size(b, n))
+          return out;
+        if (n == 0 || size == 0)
+          continue;
+
+        ranges.push_back(ByteRange{size - std::min(n, size), size - 1});
+        continue;
+      }
+
+      std::size_t first = 0;
+      if (!parse_size(a, first))
+        return out;
+
+      std::size_t last = std::numeric_limits<std::size_t>::max();
+      if (!b.empty() && !parse_size(b, last))
+        return out;
+      if (last < first)
+        return out;
+
+      if (first >= size)
+        continue;
+
+      ranges.push_back(ByteRange{first, std::min(last, size - 1)});
+    }
+
+    if (specs == 0)
+      return out;
+
+    if (ranges.empty())
+    {
+      out.status = RangeStatus::Unsatisfiable;
+      return out;
+    }
+
+    if (ranges.size() > 1)
+    {
+      std::sort(ranges.begin(), ranges.end(),
+                [](const ByteRange &x, const ByteRange &y)
+                { return x.first < y.first; });
+
+      std::vector<ByteRange> merged;
+      for (const auto &r : ranges)
+      {
+        if (!merged.empty() && r.first <= merged.back().last + 1)
+          merged.back().last = std::max(merged.back().last, r.last);
+        else
+          merged.push_back(r);
+      }
+      ranges.swap(merged);
+    }
+
+    out.status = RangeStatus::Satisfiable;
+    out.ranges = std::move(ranges);
+    return out;
+  }
+
+  /**
+   * @brief Check an If-Range precondition against the stored validators.
+   *
+   * Matches a strong ETag exactly, or a Last-Modified date exactly.
+   */
+  inline bool if_range_matches(
+      std::string_view if_range,
+      std::string_view etag,
+      std::string_view last_modified)
+  {
+    if_range = trim_ows(if_range);
+    if (if_range.empty())
+      return true;
+
+    if (if_range.front() == '"' || if_range.substr(0, 2) == "W/")
+      return !etag.empty() && etag.substr(0, 2) != "W/" && if_range == etag;
+
+    return !last_modified.empty() && if_range == last_modified;
+  }
+
+  /** @brief Format the value of a Content-Range header. */
+  inline std::string content_range(const ByteRange &r, std::size_t size)
+  {
+    return "bytes " + std::to_string(r.first) + "-" + std::to_string(r.last) +
+           "/" + std::to_string(size);
+  }
+
+  /** @brief Content-Range value of a 416 response. */
+  inline std::string unsatisfied_range(std::size_t size)
+  {
+    return "bytes */" + std::to_string(size);
+  }
+
+  /** @brief Generate a multipart boundary. */
+  inline std::string make_boundary()
+  {
+    static std::atomic<std::uint64_t> counter{0};
+
+    std::uint64_t x = static_cast<std::uint64_t>(vix::middleware::utils::Clock::now_ms_steady()) ^
+                      (counter.fetch_add(1, std::memory_order_relaxed) * 0x9E3779B97F4A7C15ull);
+
+    static constexpr char hex[] = "0123456789abcdef";
+    std::string b = "vix-byteranges-";
+    for (int i = 0; i < 16; ++i)
+    {
+      b += hex[x & 0xF];
+      x >>= 4;
+    }
+    return b;
+  }
+
+  /**
+   * @brief Build a multipart/byteranges body (RFC 9110, section 14.6).
+   *
+   * @param body Full body.
+   * @param ranges Satisfiable ranges.
+   * @param content_type Media type of the full body (may be empty).
+   * @param boundary Multipart boundary.
+   */
+  inline std::string multipart_byteranges(
+      std::string_view body,
+      const std::vector<ByteRange> &ranges,
+      std::string_view content_type,
+      std::string_view boundary)
+  {
+    std::size_t n = 0;
+    for (const auto &r : ranges)
+      n += r.length() + boundary.size() + content_type.size() + 96;
+
+    std::string out;
+    out.reserve(n + boundary.size() + 8);
+
+    for (const auto &r : ranges)
+    {
+      out += "--";
+      out += boundary;
+      out += "\r\n";
+      if (!content_type.empty())
+      {
+        out += "Content-Type: ";
+        out += content_type;
+        out += "\r\n";
+      }
+      out += "Content-Range: ";
+      out += content_range(r, body.size());
+      out += "\r\n\r\n";
+      out += body.substr(r.first, r.length());
+      out += "\r\n";
+    }
+
+    out += "--";
+    out += boundary;
+    out += "--\r\n";
+    return out;
+  }
+
+} // namespace vix::middleware::range
+
+#endif // VIX_MIDDLEWARE_HTTP_RANGE_HPP
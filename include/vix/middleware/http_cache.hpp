@@ -17,6 +17,7 @@
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -25,6 +26,15 @@
 #include <cctype>
 
 #include <vix/middleware/middleware.hpp>
+#include <vix/middleware/cache/cache_metrics.hpp>
+#include <vix/middleware/cache/entry_bytes.hpp>
+#include <vix/middleware/cache/l1_cache.hpp>
+#include <vix/middleware/cache/private_cache.hpp>
+#include <vix/middleware/cache/query_key.hpp>
+#include <vix/middleware/cache/tag_index.hpp>
+#include <vix/middleware/http/range.hpp>
+#include <vix/middleware/performance/body_stream.hpp>
+#include <vix/middleware/performance/compression.hpp>
 #include <vix/cache/Cache.hpp>
 #include <vix/cache/CacheContext.hpp>
 #include <vix/cache/CacheKey.hpp>
@@ -37,17 +47,162 @@ namespace vix::middleware
    */
   struct HttpCacheOptions
   {
+    /**
+     * @brief Request headers that are part of the cache key.
+     *
+     * Responses that already carry Content-Encoding (e.g. precompressed
+     * static_files sidecars) are only stored when "accept-encoding" is
+     * listed here, so each coding gets its own entry.
+     */
     std::vector<std::string> vary_headers{};
+
+    /**
+     * @brief Query-string canonicalization for cache keys.
+     *
+     * Sorting, allow/deny lists (e.g. cache::tracking_query_params()) and
+     * percent-encoding normalization let equivalent URLs share one entry.
+     */
+    vix::middleware::cache::QueryKeyOptions query_key{};
+
     bool cache_200_only{true};
     bool require_body{false};
 
+    /**
+     * @brief Statuses stored in the main cache (overrides cache_200_only when non-empty).
+     */
+    std::vector<int> cache_statuses{};
+
+    /**
+     * @brief Separate cache for negative responses (optional).
+     *
+     * Responses with a status in negative_statuses are stored here instead
+     * of the main cache, so they get their own TTL and byte budget and
+     * cannot crowd out real entries. Looked up after a main-cache miss.
+     */
+    std::shared_ptr<vix::cache::Cache> negative_cache{};
+
+    /**
+     * @brief Statuses stored in negative_cache.
+     */
+    std::vector<int> negative_statuses{404, 410};
+
     bool allow_bypass{true};
     std::string bypass_header{"x-vix-cache"};
     std::string bypass_value{"bypass"};
 
     std::function<vix::cache::CacheContext(Request &)> context_provider{};
+
+    /**
+     * @brief Keep pre-encoded (br/gzip) variants next to cached entries.
+     *
+     * When enabled, a client that accepts a supported coding is served a
+     * variant that was encoded once and stored under its own key. The
+     * variant carries Content-Encoding, so compression() leaves it alone.
+     */
+    bool encoded_variants{false};
+
+    /**
+     * @brief Codec settings (levels, min_size, prefer_br) used for variants.
+     */
+    performance::CompressionOptions variant_compression{};
+
+    /**
+     * @brief Tag/path-prefix invalidation index (optional).
+     *
+     * When set, every stored key is recorded with its request path and its
+     * surrogate tags (tag_header plus cache::CacheTags request state), and
+     * entries invalidated through the index are treated as misses.
+     */
+    std::shared_ptr<vix::middleware::cache::CacheTagIndex> tag_index{};
+
+    /**
+     * @brief Response header carrying surrogate tags (stripped before storing).
+     */
+    std::string tag_header{"surrogate-key"};
+
+    /**
+     * @brief Answer HEAD requests from the cached GET entry.
+     *
+     * A hit replays status and headers with an empty body and the cached
+     * Content-Length. HEAD misses reach the handler and are not stored.
+     */
+    bool serve_head{true};
+
+    /**
+     * @brief Answer "Range: bytes=" requests with 206/416 slices of 200 bodies.
+     *
+     * Ranges apply to the identity representation, so encoded variants are
+     * not used for ranged requests. If-Range is honored.
+     */
+    bool serve_ranges{true};
+
+    /**
+     * @brief Range specs above which the Range header is ignored (full 200).
+     */
+    std::size_t max_ranges{16};
+
+    /**
+     * @brief Hit/miss/bypass/store counters and top keys (optional).
+     */
+    std::shared_ptr<vix::middleware::cache::CacheMetrics> metrics{};
+
+    /**
+     * @brief Stale-if-error window in ms (0 = disabled).
+     *
+     * When the handler throws or answers 5xx on a miss, the last stored
+     * entry is served instead if it is younger than this window, marked
+     * "x-vix-cache-status: stale-error". The entry is fetched with
+     * CacheContext::NetworkError(), so the cache policy must also allow
+     * stale-if-error for at least as long.
+     */
+    std::int64_t stale_if_error_ms{0};
+
+    /**
+     * @brief Keep stored bodies gzip-compressed (compressed at rest).
+     *
+     * Identity entries of at least at_rest_min_size bytes are deflated at
+     * at_rest_level before being stored. On a hit, a client accepting gzip
+     * gets the stored bytes as is (Content-Encoding: gzip); other clients,
+     * ranged requests included, get the body inflated. Requires zlib.
+     */
+    bool compress_at_rest{false};
+    std::size_t at_rest_min_size{1024};
+    int at_rest_level{1};
+
+    /**
+     * @brief Per-thread L1 in front of the shared cache (optional).
+     *
+     * Hits on the hottest keys are then served from thread-local entries
+     * without touching the shared cache. Each hit still copies the body
+     * once into the response, which owns it as a std::string. L1 entries
+     * are dropped on tag_index invalidations and after the L1 TTL, which
+     * should stay well below the cache TTL.
+     */
+    std::shared_ptr<vix::middleware::cache::L1Cache> l1{};
+
+    /**
+     * @brief Per-principal private partitions (optional).
+     *
+     * When principal() returns a non-empty id (see
+     * auth::request_principal()), the request is looked up and stored only
+     * in that principal's partition, never in the shared cache. Replayed
+     * as "hit-private".
+     *
+     * With tag_index, private entries are recorded with record_private()
+     * and honour tag and prefix invalidation; attach the private cache
+     * with CacheTagIndex::attach_private_cache() to free them eagerly.
+     */
+    std::shared_ptr<vix::middleware::cache::PrivateCache> private_cache{};
+    vix::middleware::cache::PrincipalResolver principal{};
   };
 
+  /**
+   * @brief Entry header marking a body stored compressed at rest.
+   *
+   * Internal to the cache: it is consumed before an entry is served.
+   */
+  inline constexpr std::string_view k_at_rest_header = "x-vix-at-rest";
+
   /**
    * @brief Current monotonic time in milliseconds.
    */
@@ -104,6 +259,16 @@ namespace vix::middleware
     return h;
   }
 
+  /**
+   * @brief ASCII lowercase copy of @p s.
+   */
+  inline std::string lower_ascii(std::string s)
+  {
+    for (char &c : s)
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+  }
+
   /**
    * @brief Check if the request asks to bypass cache via a header.
    */
@@ -118,14 +283,73 @@ namespace vix::middleware
     if (v.empty())
       return false;
 
-    auto lower = [](std::string s)
+    return lower_ascii(v) == lower_ascii(opt.bypass_value);
+  }
+
+  /**
+   * @brief Fill a cache entry's body and headers from the response.
+   *
+   * A streamed response is stored from its BodyStream tee, without the
+   * transfer coding and with the stream's ETag as a header. The tee is
+   * taken before the stream's encoder, so the Content-Encoding the stream
+   * added is dropped; one set by the handler is kept.
+   *
+   * @return false for a streamed response that was not teed (tee disabled,
+   * larger than tee_max_bytes, or failed); it cannot be cached.
+   */
+  inline bool fill_entry_from_response(
+      Request &req,
+      const vix::http::Response &native_res,
+      vix::cache::CacheEntry &e)
+  {
+    e.headers = response_headers_map(native_res);
+    vix::cache::HeaderUtil::normalizeInPlace(e.headers);
+
+    const performance::BodyStream *stream = performance::body_stream(req);
+    if (!stream || !stream->started())
     {
-      for (char &c : s)
-        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-      return s;
-    };
+      e.body = native_res.body();
+      return true;
+    }
+
+    const std::string *teed = stream->tee();
+    if (!teed)
+      return false;
+
+    e.body = *teed;
+    e.headers.erase("transfer-encoding");
+    e.headers.erase("trailer");
 
-    return lower(v) == lower(opt.bypass_value);
+    // The tee holds identity bytes only when the stream did the encoding;
+    // a coding set by the handler describes the teed bytes too.
+    if (!stream->encoding().empty())
+      e.headers.erase("content-encoding");
+
+    if (!stream->etag().empty())
+      e.headers["etag"] = stream->etag();
+
+    return true;
+  }
+
+  /**
+   * @brief Collect a response's surrogate tags and strip the tag header from @p e.
+   *
+   * Tags come from opt.tag_header and the cache::CacheTags request state.
+   */
+  inline std::vector<std::string> take_response_tags(
+      Request &req,
+      const vix::http::Response &native_res,
+      vix::cache::CacheEntry &e,
+      const HttpCacheOptions &opt)
+  {
+    std::vector<std::string> tags =
+        vix::middleware::cache::split_tags(native_res.header(opt.tag_header));
+
+    if (auto *st = req.try_state<vix::middleware::cache::CacheTags>())
+      tags.insert(tags.end(), st->tags.begin(), st->tags.end());
+
+    e.headers.erase(lower_ascii(opt.tag_header));
+    return tags;
   }
 
   /**
@@ -148,11 +372,340 @@ namespace vix::middleware
     return true;
   }
 
+  /**
+   * @brief Check whether an entry may be stored under a key built from @p opt.
+   *
+   * An entry with a Content-Encoding is only valid for clients accepting
+   * that coding. Without Accept-Encoding in the key, a br body stored for
+   * one client would be replayed to every other one, so it is refused.
+   */
+  inline bool coding_in_key(const vix::cache::CacheEntry &e, const HttpCacheOptions &opt)
+  {
+    auto it = e.headers.find("content-encoding");
+    if (it == e.headers.end() || it->second.empty() || ieq_ascii(it->second, "identity"))
+      return true;
+
+    for (const auto &h : opt.vary_headers)
+    {
+      if (ieq_ascii(h, "accept-encoding"))
+        return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Check whether @p status is in @p list.
+   */
+  inline bool status_listed(int status, const std::vector<int> &list)
+  {
+    for (int s : list)
+    {
+      if (s == status)
+        return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Check whether a response status may be stored in the main cache.
+   *
+   * Partial (206) responses are never stored.
+   */
+  inline bool is_cacheable_status(int status, const HttpCacheOptions &opt)
+  {
+    if (status == 206)
+      return false;
+    if (!opt.cache_statuses.empty())
+      return status_listed(status, opt.cache_statuses);
+    return !opt.cache_200_only || status == 200;
+  }
+
+  /**
+   * @brief Check whether a Cache-Control value carries a directive.
+   *
+   * Matches the directive name only, so "private" also matches the
+   * qualified form private="set-cookie".
+   */
+  inline bool has_cache_directive(std::string_view cache_control, std::string_view name)
+  {
+    while (!cache_control.empty())
+    {
+      const std::size_t comma = cache_control.find(',');
+      std::string_view d = cache_control.substr(0, comma);
+      cache_control = (comma == std::string_view::npos) ? std::string_view{} : cache_control.substr(comma + 1);
+
+      d = range::trim_ows(d.substr(0, d.find('=')));
+      if (ieq_ascii(d, name))
+        return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Cache key of the encoded variant of @p key.
+   */
+  inline std::string variant_key(const std::string &key, std::string_view encoding)
+  {
+    std::string k;
+    k.reserve(key.size() + encoding.size() + 4);
+    k += key;
+    k += "|ae=";
+    k += encoding;
+    return k;
+  }
+
+  /**
+   * @brief Check whether a cache entry may get an encoded variant.
+   *
+   * Entry headers are expected to be normalized (lowercase keys).
+   */
+  inline bool variant_eligible(
+      const vix::cache::CacheEntry &e,
+      const performance::CompressionOptions &opt)
+  {
+    if (!performance::is_compressible_status(e.status))
+      return false;
+    if (e.body.size() < opt.min_size)
+      return false;
+    if (e.headers.find("content-encoding") != e.headers.end())
+      return false;
+
+    auto ct = e.headers.find("content-type");
+    return performance::worth_compressing(ct == e.headers.end() ? std::string_view{} : std::string_view(ct->second), e.body, opt);
+  }
+
+  /**
+   * @brief Encode a cache entry body into a variant entry.
+   *
+   * The variant keeps the source creation time so both expire together.
+   *
+   * @return The variant, or nullopt if the coding is unavailable or failed.
+   */
+  inline std::optional<vix::cache::CacheEntry> make_encoded_variant(
+      const vix::cache::CacheEntry &e,
+      const std::string &encoding,
+      const performance::CompressionOptions &opt)
+  {
+    vix::cache::CacheEntry v;
+    if (!performance::compress_with(encoding, e.body, v.body, opt))
+      return std::nullopt;
+
+    v.status = e.status;
+    v.created_at_ms = e.created_at_ms;
+    v.headers = e.headers;
+    v.headers["content-encoding"] = encoding;
+
+    auto &vary = v.headers["vary"];
+    if (!performance::contains_token_icase(vary, "accept-encoding"))
+      vary = vary.empty() ? std::string("Accept-Encoding") : vary + ", Accept-Encoding";
+
+    return v;
+  }
+
+  /**
+   * @brief Compress an entry body for storage (see compress_at_rest).
+   *
+   * Leaves the entry untouched when it is small, already encoded, of a
+   * type that is not worth compressing, or does not shrink.
+   *
+   * @return true if the body was compressed.
+   */
+  inline bool pack_at_rest(vix::cache::CacheEntry &e, const HttpCacheOptions &opt)
+  {
+    if (e.body.size() < opt.at_rest_min_size)
+      return false;
+    if (e.headers.find("content-encoding") != e.headers.end())
+      return false;
+
+    performance::CompressionOptions copt{};
+    copt.gzip_level = opt.at_rest_level;
+
+    auto ct = e.headers.find("content-type");
+    if (!performance::is_compressible_type(ct == e.headers.end() ? std::string_view{} : std::string_view(ct->second), copt))
+      return false;
+
+    std::string packed;
+    if (!performance::compress_with("gzip", e.body, packed, copt) || packed.size() >= e.body.size())
+      return false;
+
+    e.body = std::move(packed);
+    e.headers[std::string(k_at_rest_header)] = "gzip";
+    return true;
+  }
+
+  /**
+   * @brief Turn an entry stored compressed at rest back into a servable one.
+   *
+   * With @p pass_through the compressed body is kept and labeled with
+   * Content-Encoding; otherwise it is inflated.
+   *
+   * @return false if the body could not be inflated.
+   */
+  inline bool unpack_at_rest(vix::cache::CacheEntry &e, bool pass_through)
+  {
+    auto it = e.headers.find(std::string(k_at_rest_header));
+    if (it == e.headers.end())
+      return true;
+
+    const std::string coding = std::move(it->second);
+    e.headers.erase(it);
+
+    auto &vary = e.headers["vary"];
+    if (!performance::contains_token_icase(vary, "accept-encoding"))
+      vary = vary.empty() ? std::string("Accept-Encoding") : vary + ", Accept-Encoding";
+
+    if (pass_through)
+    {
+      e.headers["content-encoding"] = coding;
+      return true;
+    }
+
+    std::string plain;
+    if (!performance::decompress_with(coding, e.body, plain))
+      return false;
+
+    e.body = std::move(plain);
+    return true;
+  }
+
+  /**
+   * @brief Replay a cached entry into the response.
+   *
+   * The entry is taken by value and its body is moved into the response,
+   * so a lookup result costs a single body copy end to end.
+   */
+  inline void serve_cached_entry(
+      Response &res,
+      vix::cache::CacheEntry e,
+      std::string_view cache_status)
+  {
+    res.status(e.status);
+
+    for (const auto &kv : e.headers)
+    {
+      if (ieq_ascii(kv.first, "content-length"))
+        continue;
+
+      res.header(kv.first, kv.second);
+    }
+
+    res.header("x-vix-cache-status", std::string(cache_status));
+    res.res.set_body(std::move(e.body));
+  }
+
+  /**
+   * @brief Rewrite a full 200 response into a Range reply if requested.
+   *
+   * Single ranges become a 206 slice, multiple ranges a 206
+   * multipart/byteranges body, ranges past the end a 416.
+   *
+   * @return true if the response was rewritten.
+   */
+  inline bool apply_byte_range(Request &req, Response &res, const HttpCacheOptions &opt)
+  {
+    auto &raw = res.res;
+    if (!opt.serve_ranges || raw.status() != 200)
+      return false;
+
+    const std::string h = req.header("range");
+    if (h.empty())
+      return false;
+
+    if (!range::if_range_matches(req.header("if-range"), raw.header("etag"), raw.header("last-modified")))
+      return false;
+
+    const std::string &body = raw.body();
+    const range::RangeSet rs = range::parse_range(h, body.size(), opt.max_ranges);
+
+    if (rs.status == range::RangeStatus::Ignore)
+      return false;
+
+    if (rs.status == range::RangeStatus::Unsatisfiable)
+    {
+      res.status(416);
+      res.header("Content-Range", range::unsatisfied_range(body.size()));
+      raw.set_body(std::string{});
+      return true;
+    }
+
+    if (rs.ranges.size() == 1)
+    {
+      const auto &r = rs.ranges.front();
+      std::string slice = body.substr(r.first, r.length());
+
+      res.status(206);
+      res.header("Content-Range", range::content_range(r, body.size()));
+      raw.set_body(std::move(slice));
+      return true;
+    }
+
+    const std::string boundary = range::make_boundary();
+    std::string multi = range::multipart_byteranges(body, rs.ranges, raw.header("content-type"), boundary);
+
+    res.status(206);
+    res.header("Content-Type", "multipart/byteranges; boundary=" + boundary);
+    raw.set_body(std::move(multi));
+    return true;
+  }
+
+  /**
+   * @brief Reply to a cache hit, honoring HEAD and Range.
+   */
+  inline void reply_from_cache(
+      Request &req,
+      Response &res,
+      vix::cache::CacheEntry e,
+      const HttpCacheOptions &opt,
+      std::string_view cache_status = "hit")
+  {
+    const bool head = req.method() == "HEAD";
+    const std::size_t length = e.body.size();
+    const bool full = e.status == 200;
+
+    serve_cached_entry(res, std::move(e), cache_status);
+
+    if (full && opt.serve_ranges)
+      res.header("Accept-Ranges", "bytes");
+
+    if (head)
+    {
+      res.res.set_body(std::string{});
+      res.header("Content-Length", std::to_string(length));
+      return;
+    }
+
+    apply_byte_range(req, res, opt);
+  }
+
   /**
    * @brief HTTP cache middleware for GET responses.
    *
    * Computes a cache key from method/path/query/headers (with optional vary headers),
    * replays cached responses on hit, and stores successful responses on miss.
+   *
+   * With encoded_variants, the negotiated coding (br/gzip) is looked up first
+   * under its own key. A missing variant is encoded once from the identity
+   * entry and stored, so later hits skip compression entirely.
+   *
+   * HEAD is answered from the GET entry, and Range requests get 206/416
+   * slices of cached 200 bodies (see serve_head / serve_ranges).
+   *
+   * With negative_cache, 404/410 (negative_statuses) responses are stored
+   * in that cache and replayed as "hit-negative".
+   *
+   * With stale_if_error_ms, a handler failure (exception or 5xx) on a miss
+   * is answered with the expired entry when one is still stored.
+   *
+   * With compress_at_rest, entries are stored gzip-compressed and inflated
+   * on hits only for clients that do not accept gzip.
+   *
+   * With private_cache, authenticated requests use their principal's
+   * partition. Responses marked Cache-Control: private are never put in the
+   * shared cache, and no-store responses are not stored at all.
+   *
+   * Responses that arrive with a Content-Encoding (precompressed
+   * static_files sidecars, handlers that encode themselves) are stored only
+   * when vary_headers contains "accept-encoding" (see coding_in_key).
    */
   inline HttpMiddleware http_cache(
       std::shared_ptr<vix::cache::Cache> cache,
@@ -167,71 +720,326 @@ namespace vix::middleware
         return;
       }
 
-      if (req.method() != "GET")
+      const bool head = opt.serve_head && req.method() == "HEAD";
+      if (req.method() != "GET" && !head)
       {
         next();
         return;
       }
 
+      using vix::middleware::cache::CacheEvent;
+
       if (has_bypass(req, opt))
       {
         next();
         res.header("x-vix-cache-status", "bypass");
+        if (opt.metrics)
+          opt.metrics->record(CacheEvent::Bypass, req.path(), {});
         return;
       }
 
-      const std::string query_raw = extract_query_raw_from_target(req.target());
+      const std::string query_raw = vix::middleware::cache::canonicalize_query(
+          extract_query_raw_from_target(req.target()), opt.query_key);
       auto req_headers = request_headers_map(req);
       vix::cache::HeaderUtil::normalizeInPlace(req_headers);
 
+      // HEAD shares the GET entry.
       const std::string key = vix::cache::CacheKey::fromRequest(
-          req.method(), req.path(), query_raw, req_headers, opt.vary_headers);
+          "GET", req.path(), query_raw, req_headers, opt.vary_headers);
 
       vix::cache::CacheContext ctx =
           opt.context_provider ? opt.context_provider(req)
                                : vix::cache::CacheContext::Online();
 
+      const bool ranged = opt.serve_ranges && !req.header("range").empty();
+
+      if (opt.private_cache && opt.principal)
+      {
+        if (const std::string principal = opt.principal(req); !principal.empty())
+        {
+          const std::int64_t now = now_ms();
+
+          auto hit = opt.private_cache->get(principal, key, now);
+          if (hit && opt.tag_index &&
+              opt.tag_index->is_invalidated(vix::middleware::cache::private_index_key(key), hit->created_at_ms))
+            hit = nullptr;
+
+          if (hit)
+          {
+            if (opt.metrics)
+              opt.metrics->record(CacheEvent::Hit, req.path(), key);
+            // The one body copy of a private hit: the entry stays shared.
+            reply_from_cache(req, res, *hit, opt, "hit-private");
+            return;
+          }
+
+          next();
+          res.header("x-vix-cache-status", "miss-private");
+
+          if (opt.metrics)
+            opt.metrics->record(CacheEvent::Miss, req.path(), key);
+
+          if (head)
+            return;
+
+          auto &native_res = res.res;
+          if (is_cacheable_status(native_res.status(), opt) &&
+              !has_cache_directive(native_res.header("cache-control"), "no-store"))
+          {
+            vix::cache::CacheEntry e;
+            e.status = native_res.status();
+            e.created_at_ms = now;
+
+            bool ok = fill_entry_from_response(req, native_res, e) && coding_in_key(e, opt);
+
+            // Produced before a concurrent invalidation: serve it, don't store it.
+            if (ok && opt.tag_index)
+              ok = opt.tag_index->record_private(
+                  key, req.path(), take_response_tags(req, native_res, e, opt), now);
+
+            if (ok)
+            {
+              const std::size_t bytes = vix::middleware::cache::entry_bytes(key, e);
+              if (opt.private_cache->put(principal, key, vix::middleware::cache::make_shared_entry(std::move(e))) && opt.metrics)
+                opt.metrics->record(CacheEvent::Store, req.path(), key, bytes);
+            }
+          }
+
+          if (ranged && !vix::middleware::utils::body_streamed(req))
+            apply_byte_range(req, res, opt);
+          return;
+        }
+      }
+
+      const std::string encoding =
+          (opt.encoded_variants && !ranged)
+              ? performance::negotiate_encoding(req.header("accept-encoding"), opt.variant_compression)
+              : std::string{};
+
+      // Entries compressed at rest go out as is to gzip-capable clients.
+      const bool at_rest_pass =
+          opt.compress_at_rest && !ranged &&
+          (encoding.empty() || encoding == "gzip") &&
+          performance::token_allowed(req.header("accept-encoding"), "gzip");
+
       const std::int64_t t0 = now_ms();
 
-      if (auto hit = cache->get(key, t0, ctx))
+      auto live = [&](const std::optional<vix::cache::CacheEntry> &hit)
       {
-        res.status(hit->status);
+        if (!hit)
+          return false;
+        if (opt.tag_index && opt.tag_index->is_invalidated(key, hit->created_at_ms))
+          return false;
+
+        if (opt.metrics)
+          opt.metrics->record(CacheEvent::Hit, req.path(), key);
+        return true;
+      };
 
-        for (const auto &kv : hit->headers)
+      const std::uint64_t l1_epoch =
+          (opt.l1 && opt.tag_index) ? opt.tag_index->generation() : 0;
+
+      // L1 first. A shared-cache hit is moved into the thread's L1 and the
+      // response gets a copy of it, so every hit costs one body copy.
+      auto find = [&](const std::string &k) -> std::optional<vix::cache::CacheEntry>
+      {
+        if (opt.l1)
         {
-          if (ieq_ascii(kv.first, "content-length"))
-            continue;
+          if (auto e = opt.l1->get(k, t0, l1_epoch))
+          {
+            if (opt.metrics)
+              opt.metrics->record(CacheEvent::Hit, req.path(), key);
+            return *e;
+          }
+        }
+
+        auto hit = cache->get(k, t0, ctx);
+        if (!live(hit))
+          return std::nullopt;
 
-          res.header(kv.first, kv.second);
+        if (opt.l1)
+        {
+          auto shared = vix::middleware::cache::make_shared_entry(std::move(*hit));
+          opt.l1->put(k, shared, t0, l1_epoch);
+          return *shared;
         }
+        return hit;
+      };
+
+      auto put_entry = [&](const std::string &k, const vix::cache::CacheEntry &e)
+      {
+        if (opt.metrics)
+          opt.metrics->record(CacheEvent::Store, req.path(), k, vix::middleware::cache::entry_bytes(k, e));
+        cache->put(k, e);
+      };
 
-        res.header("x-vix-cache-status", "hit");
-        res.res.set_body(hit->body);
+      auto put_variant = [&](const vix::cache::CacheEntry &v)
+      {
+        const std::string vkey = variant_key(key, encoding);
+        put_entry(vkey, v);
+        if (opt.tag_index)
+          opt.tag_index->link(key, vkey);
+      };
+
+      if (!encoding.empty())
+      {
+        if (auto hit = find(variant_key(key, encoding)))
+        {
+          reply_from_cache(req, res, std::move(*hit), opt);
+          return;
+        }
+      }
+
+      if (auto hit = find(key); hit && unpack_at_rest(*hit, at_rest_pass))
+      {
+        if (!encoding.empty() && variant_eligible(*hit, opt.variant_compression))
+        {
+          if (auto v = make_encoded_variant(*hit, encoding, opt.variant_compression))
+          {
+            put_variant(*v);
+            reply_from_cache(req, res, std::move(*v), opt);
+            return;
+          }
+        }
+
+        reply_from_cache(req, res, std::move(*hit), opt);
         return;
       }
 
-      next();
+      if (opt.negative_cache)
+      {
+        if (auto hit = opt.negative_cache->get(key, t0, ctx); live(hit))
+        {
+          reply_from_cache(req, res, std::move(*hit), opt, "hit-negative");
+          return;
+        }
+      }
+
+      // Replace a failed response with the last stored entry, if recent enough.
+      auto serve_stale = [&]()
+      {
+        if (opt.stale_if_error_ms <= 0)
+          return false;
+
+        auto stale = cache->get(key, now_ms(), vix::cache::CacheContext::NetworkError());
+        if (!stale || now_ms() - stale->created_at_ms > opt.stale_if_error_ms)
+          return false;
+        if (opt.tag_index && opt.tag_index->is_invalidated(key, stale->created_at_ms))
+          return false;
+        if (!unpack_at_rest(*stale, at_rest_pass))
+          return false;
+
+        res.res = vix::http::Response{};
+        reply_from_cache(req, res, std::move(*stale), opt, "stale-error");
+
+        if (opt.metrics)
+          opt.metrics->record(CacheEvent::Stale, req.path(), key);
+        return true;
+      };
+
+      if (opt.stale_if_error_ms > 0)
+      {
+        try
+        {
+          next();
+        }
+        catch (...)
+        {
+          if (!serve_stale())
+            throw;
+          return;
+        }
+
+        if (res.res.status() >= 500 && serve_stale())
+          return;
+      }
+      else
+      {
+        next();
+      }
 
       auto &native_res = res.res;
       const int status_code = native_res.status();
 
       res.header("x-vix-cache-status", "miss");
 
-      if (opt.cache_200_only && status_code != 200)
-        return;
+      if (opt.metrics)
+        opt.metrics->record(CacheEvent::Miss, req.path(), key);
 
-      if (opt.require_body && native_res.body().empty())
+      if (head)
         return;
 
-      vix::cache::CacheEntry e;
-      e.status = status_code;
-      e.body = native_res.body();
-      e.created_at_ms = t0;
+      const bool streamed = vix::middleware::utils::body_streamed(req);
+
+      // Store the full body first; a ranged request then gets its slice.
+      auto store = [&]()
+      {
+        const bool negative =
+            opt.negative_cache && status_listed(status_code, opt.negative_statuses);
+
+        if (!negative && !is_cacheable_status(status_code, opt))
+          return;
+
+        const std::string cache_control = native_res.header("cache-control");
+        if (has_cache_directive(cache_control, "no-store") ||
+            has_cache_directive(cache_control, "private"))
+          return;
+
+        vix::cache::CacheEntry e;
+        e.status = status_code;
+        e.created_at_ms = t0;
+
+        if (!fill_entry_from_response(req, native_res, e) || !coding_in_key(e, opt))
+          return;
+
+        if (!negative && opt.require_body && e.body.empty())
+          return;
+
+        if (opt.tag_index)
+        {
+          std::vector<std::string> tags = take_response_tags(req, native_res, e, opt);
+
+          // Produced before a concurrent invalidation: serve it, don't store it.
+          if (!opt.tag_index->record(key, req.path(), std::move(tags), t0))
+            return;
+        }
+
+        if (negative)
+        {
+          if (opt.metrics)
+            opt.metrics->record(CacheEvent::Store, req.path(), key, vix::middleware::cache::entry_bytes(key, e));
+          opt.negative_cache->put(key, e);
+          return;
+        }
+
+        // The streamed response is already on its way; store it as is.
+        if (streamed)
+        {
+          put_entry(key, e);
+          return;
+        }
+
+        if (!encoding.empty() && variant_eligible(e, opt.variant_compression))
+        {
+          if (auto v = make_encoded_variant(e, encoding, opt.variant_compression))
+          {
+            put_variant(*v);
+            res.header("Content-Encoding", encoding);
+            performance::add_vary_accept_encoding(res);
+            native_res.set_body(std::move(v->body));
+          }
+        }
+
+        if (opt.compress_at_rest && pack_at_rest(e, opt))
+          performance::add_vary_accept_encoding(res);
+
+        put_entry(key, e);
+      };
 
-      e.headers = response_headers_map(native_res);
-      vix::cache::HeaderUtil::normalizeInPlace(e.headers);
+      store();
 
-      cache->put(key, std::move(e));
+      if (ranged && !streamed)
+        apply_byte_range(req, res, opt);
     };
   }
 
@@ -64,6 +64,25 @@ namespace vix::middleware::observability
         std::string_view name,
         double ms,
         std::unordered_map<std::string, std::string> labels = {}) = 0;
+
+    /**
+     * @brief Set a gauge metric to its current value.
+     *
+     * Optional: the default implementation drops the value.
+     *
+     * @param name Metric name.
+     * @param value Current value.
+     * @param labels Metric labels (key/value pairs).
+     */
+    virtual void set_gauge(
+        std::string_view name,
+        double value,
+        std::unordered_map<std::string, std::string> labels = {})
+    {
+      (void)name;
+      (void)value;
+      (void)labels;
+    }
   };
 
   /**
@@ -71,6 +90,7 @@ namespace vix::middleware::observability
    *
    * Stores:
    * - counters by (name + sorted labels)
+   * - gauges by (name + sorted labels)
    * - the last observation for each observation name (count + last value + labels)
    */
   class InMemoryMetrics final : public IMetricsSink
@@ -175,6 +195,37 @@ namespace vix::middleware::observability
       r.labels = std::move(labels);
     }
 
+    /**
+     * @brief Set a gauge in memory.
+     */
+    void set_gauge(
+        std::string_view name,
+        double value,
+        std::unordered_map<std::string, std::string> labels = {}) override
+    {
+      CounterKey k{std::string(name), normalize_labels(std::move(labels))};
+
+      std::lock_guard<std::mutex> lock(mu_);
+      gauges_[std::move(k)] = value;
+    }
+
+    /**
+     * @brief Current value of a gauge (0 if never set).
+     *
+     * @param name Metric name.
+     * @param labels Exact label set of the gauge.
+     */
+    double gauge(
+        std::string_view name,
+        std::unordered_map<std::string, std::string> labels = {}) const
+    {
+      CounterKey k{std::string(name), normalize_labels(std::move(labels))};
+
+      std::lock_guard<std::mutex> lock(mu_);
+      auto it = gauges_.find(k);
+      return it == gauges_.end() ? 0.0 : it->second;
+    }
+
     /**
      * @brief Sum a counter across all label sets for a given metric name.
      *
@@ -224,6 +275,7 @@ namespace vix::middleware::observability
   private:
     mutable std::mutex mu_;
     std::unordered_map<CounterKey, std::uint64_t, CounterKeyHash> counters_{};
+    std::unordered_map<CounterKey, double, CounterKeyHash> gauges_{};
     std::unordered_map<std::string, Obs> observations_{};
   };
 
@@ -21,6 +21,7 @@
 #include <nlohmann/json.hpp>
 
 #include <vix/middleware/middleware.hpp>
+#include <vix/middleware/utils/body.hpp>
 #include <vix/utils/String.hpp>
 
 namespace vix::middleware::parsers
@@ -53,7 +54,7 @@ namespace vix::middleware::parsers
     {
       auto &req = ctx.req();
 
-      const std::string body = req.body();
+      const std::string_view body = vix::middleware::utils::body_view(req);
       if (body.empty())
       {
         if (!opt.allow_empty)
@@ -108,7 +109,7 @@ namespace vix::middleware::parsers
       try
       {
         const nlohmann::json parsed =
-            nlohmann::json::parse(body, nullptr, /*allow_exceptions*/ true, /*ignore_comments*/ true);
+            nlohmann::json::parse(body.begin(), body.end(), nullptr, /*allow_exceptions*/ true, /*ignore_comments*/ true);
 
         if (opt.store_in_state)
         {
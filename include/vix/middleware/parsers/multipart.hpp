@@ -19,6 +19,7 @@
 #include <utility>
 
 #include <vix/middleware/middleware.hpp>
+#include <vix/middleware/utils/body.hpp>
 #include <vix/utils/String.hpp>
 
 namespace vix::middleware::parsers
@@ -55,7 +56,7 @@ namespace vix::middleware::parsers
     {
       auto &req = ctx.req();
 
-      const std::string body = req.body();
+      const std::string_view body = vix::middleware::utils::body_view(req);
       if (opt.max_bytes > 0 && body.size() > opt.max_bytes)
       {
         Error e;
@@ -28,6 +28,7 @@
 #include <vector>
 
 #include <vix/middleware/middleware.hpp>
+#include <vix/middleware/utils/body.hpp>
 #include <vix/utils/String.hpp>
 
 namespace vix::middleware::parsers
@@ -365,7 +366,7 @@ namespace vix::middleware::parsers
         }
       }
 
-      const std::string body = req.body();
+      const std::string_view body = vix::middleware::utils::body_view(req);
 
       if (opt.max_bytes > 0 && body.size() > opt.max_bytes)
       {
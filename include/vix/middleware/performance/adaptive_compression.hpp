@@ -0,0 +1,363 @@
+/**
+ *
+ *  @file adaptive_compression.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_ADAPTIVE_COMPRESSION_HPP
+#define VIX_ADAPTIVE_COMPRESSION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include <vix/middleware/observability/metrics.hpp>
+#include <vix/middleware/utils/clock.hpp>
+
+namespace vix::middleware::performance
+{
+  /**
+   * @brief Bounds and starting point of one codec's level.
+   */
+  struct LevelRange
+  {
+    int min{1};
+    int max{9};
+    int start{6};
+  };
+
+  /**
+   * @brief Options for AdaptiveCompression.
+   */
+  struct AdaptiveCompressionOptions
+  {
+    /**
+     * @brief Target compression time per response, in ms.
+     *
+     * Levels go down while the recent average is above it, and up while
+     * it is below half of it (and the CPU is not busy).
+     */
+    double budget_ms{2.0};
+
+    /**
+     * @brief Response size budget_ms applies to (0 = recent average size).
+     *
+     * The controller compares the codec's per-byte cost times this size
+     * with the budget, so a few unusually large or small bodies do not
+     * swing the level.
+     */
+    std::size_t budget_bytes{0};
+
+    LevelRange gzip{1, 9, 6};
+    LevelRange brotli{1, 11, 5};
+    LevelRange zstd{1, 19, 3};
+
+    /**
+     * @brief Process CPU usage (0..1) above which levels go down.
+     */
+    double cpu_high{0.85};
+
+    /**
+     * @brief Process CPU usage (0..1) below which levels may go up.
+     */
+    double cpu_low{0.5};
+
+    /**
+     * @brief Minimum time between two level changes.
+     */
+    std::int64_t interval_ms{1000};
+
+    /**
+     * @brief Weight of the newest sample in the moving averages (0..1).
+     */
+    double smoothing{0.2};
+
+    /**
+     * @brief CPU usage source (0..1). Defaults to the process CPU time
+     * over all cores (getrusage; unavailable on Windows, where it reads 0).
+     */
+    std::function<double()> cpu_load{};
+
+    /**
+     * @brief Sink for the current levels (optional).
+     *
+     * Receives <prefix>_level (set at construction, then on every
+     * adjustment) and <prefix>_ms gauges labeled with the encoding, and a
+     * <prefix>_cpu_ratio gauge.
+     */
+    std::shared_ptr<vix::middleware::observability::IMetricsSink> metrics{};
+    std::string metrics_prefix{"vix_compression"};
+  };
+
+  /**
+   * @brief Process CPU usage since the previous call, over all cores.
+   */
+  class ProcessCpuSampler final
+  {
+  public:
+    /** @brief Usage in [0, 1] since the previous call (0 on the first). */
+    double sample()
+    {
+      const double cpu = cpu_seconds_();
+      const std::int64_t now = vix::middleware::utils::Clock::now_ms_steady();
+
+      std::lock_guard<std::mutex> lock(mu_);
+      double ratio = 0.0;
+
+      if (last_wall_ms_ != 0 && now > last_wall_ms_)
+      {
+        const unsigned cores = std::thread::hardware_concurrency();
+        const double wall = static_cast<double>(now - last_wall_ms_) / 1000.0;
+        ratio = (cpu - last_cpu_) / (wall * (cores == 0 ? 1 : cores));
+      }
+
+      last_cpu_ = cpu;
+      last_wall_ms_ = now;
+      return ratio < 0.0 ? 0.0 : (ratio > 1.0 ? 1.0 : ratio);
+    }
+
+  private:
+    static double cpu_seconds_()
+    {
+#if !defined(_WIN32)
+      rusage ru{};
+      if (::getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0.0;
+
+      return static_cast<double>(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+             static_cast<double>(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+#else
+      return 0.0;
+#endif
+    }
+
+  private:
+    std::mutex mu_;
+    double last_cpu_{0.0};
+    std::int64_t last_wall_ms_{0};
+  };
+
+  /**
+   * @brief Compression level controller holding a per-response time budget.
+   *
+   * compression() asks level() for the gzip/br/zstd level, times the
+   * codec, and reports it with record(). The controller keeps moving
+   * averages of time per response, time per byte and response size for
+   * each codec. The expected cost is the time per byte times budget_bytes
+   * (or the average size) and, at most once per interval_ms, each level
+   * moves one step:
+   * - down when the cost exceeds budget_ms or CPU usage exceeds cpu_high
+   * - up when the cost is under budget_ms / 2 and CPU usage is under cpu_low
+   *
+   * Levels stay within their LevelRange. Thread-safe; level() is a
+   * relaxed atomic load.
+   */
+  class AdaptiveCompression final
+  {
+  public:
+    explicit AdaptiveCompression(AdaptiveCompressionOptions opt = {})
+        : opt_(std::move(opt)),
+          last_adjust_ms_(vix::middleware::utils::Clock::now_ms_steady())
+    {
+      codecs_[0].init("gzip", opt_.gzip);
+      codecs_[1].init("br", opt_.brotli);
+      codecs_[2].init("zstd", opt_.zstd);
+
+      if (!opt_.cpu_load)
+      {
+        auto sampler = std::make_shared<ProcessCpuSampler>();
+        opt_.cpu_load = [sampler]()
+        { return sampler->sample(); };
+      }
+
+      for (const auto &c : codecs_)
+        publish_level_(c);
+    }
+
+    AdaptiveCompression(const AdaptiveCompression &) = delete;
+    AdaptiveCompression &operator=(const AdaptiveCompression &) = delete;
+
+    /**
+     * @brief Current level for an encoding.
+     *
+     * @param encoding "gzip", "br" or "zstd".
+     * @param fallback Returned for other encodings.
+     */
+    int level(std::string_view encoding, int fallback = 0) const
+    {
+      const Codec *c = find_(encoding);
+      return c ? c->level.load(std::memory_order_relaxed) : fallback;
+    }
+
+    /**
+     * @brief Report one compression run and adjust levels if due.
+     *
+     * @param encoding Coding used.
+     * @param bytes Uncompressed size.
+     * @param elapsed_ns Time spent in the codec.
+     */
+    void record(std::string_view encoding, std::size_t bytes, std::int64_t elapsed_ns)
+    {
+      Codec *c = find_(encoding);
+      if (!c)
+        return;
+
+      const double ms = static_cast<double>(elapsed_ns) / 1e6;
+      const double ns_per_byte = bytes ? static_cast<double>(elapsed_ns) / static_cast<double>(bytes) : 0.0;
+      const std::int64_t now = vix::middleware::utils::Clock::now_ms_steady();
+
+      std::lock_guard<std::mutex> lock(mu_);
+
+      const double a = opt_.smoothing;
+      c->avg_ms = c->samples ? c->avg_ms + a * (ms - c->avg_ms) : ms;
+      c->avg_ns_per_byte = c->samples ? c->avg_ns_per_byte + a * (ns_per_byte - c->avg_ns_per_byte) : ns_per_byte;
+      c->avg_bytes = c->samples ? c->avg_bytes + a * (static_cast<double>(bytes) - c->avg_bytes) : static_cast<double>(bytes);
+      ++c->samples;
+
+      if (now - last_adjust_ms_ < opt_.interval_ms)
+        return;
+
+      last_adjust_ms_ = now;
+      adjust_locked_();
+    }
+
+    /** @brief Recent average compression time per response, in ms. */
+    double average_ms(std::string_view encoding) const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      const Codec *c = find_(encoding);
+      return c ? c->avg_ms : 0.0;
+    }
+
+    /** @brief Recent average compression time per input byte, in ns. */
+    double average_ns_per_byte(std::string_view encoding) const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      const Codec *c = find_(encoding);
+      return c ? c->avg_ns_per_byte : 0.0;
+    }
+
+    const AdaptiveCompressionOptions &options() const noexcept { return opt_; }
+
+  private:
+    struct Codec
+    {
+      std::string_view name;
+      LevelRange range{};
+      std::atomic<int> level{0};
+      double avg_ms{0.0};
+      double avg_ns_per_byte{0.0};
+      double avg_bytes{0.0};
+      std::uint64_t samples{0};
+
+      void init(std::string_view n, LevelRange r)
+      {
+        name = n;
+        if (r.max < r.min)
+          r.max = r.min;
+        r.start = r.start < r.min ? r.min : (r.start > r.max ? r.max : r.start);
+        range = r;
+        level.store(r.start, std::memory_order_relaxed);
+      }
+    };
+
+    Codec *find_(std::string_view encoding)
+    {
+      for (auto &c : codecs_)
+      {
+        if (c.name == encoding)
+          return &c;
+      }
+      return nullptr;
+    }
+
+    const Codec *find_(std::string_view encoding) const
+    {
+      for (const auto &c : codecs_)
+      {
+        if (c.name == encoding)
+          return &c;
+      }
+      return nullptr;
+    }
+
+    /**
+     * @brief Expected time for one budget_bytes response, in ms.
+     */
+    double cost_ms_(const Codec &c) const
+    {
+      const double bytes = opt_.budget_bytes ? static_cast<double>(opt_.budget_bytes) : c.avg_bytes;
+      return c.avg_ns_per_byte * bytes / 1e6;
+    }
+
+    void publish_level_(const Codec &c) const
+    {
+      if (opt_.metrics)
+        opt_.metrics->set_gauge(opt_.metrics_prefix + "_level",
+                                static_cast<double>(c.level.load(std::memory_order_relaxed)),
+                                {{"encoding", std::string(c.name)}});
+    }
+
+    /**
+     * @brief Move each sampled codec's level one step.
+     *
+     * Caller must hold mu_.
+     */
+    void adjust_locked_()
+    {
+      const double cpu = opt_.cpu_load ? opt_.cpu_load() : 0.0;
+      const auto &sink = opt_.metrics;
+
+      for (auto &c : codecs_)
+      {
+        if (c.samples == 0)
+          continue;
+
+        int lvl = c.level.load(std::memory_order_relaxed);
+        const double cost = cost_ms_(c);
+
+        if (cost > opt_.budget_ms || cpu > opt_.cpu_high)
+          --lvl;
+        else if (cost < opt_.budget_ms / 2.0 && cpu < opt_.cpu_low)
+          ++lvl;
+
+        lvl = lvl < c.range.min ? c.range.min : (lvl > c.range.max ? c.range.max : lvl);
+        c.level.store(lvl, std::memory_order_relaxed);
+
+        publish_level_(c);
+        if (sink)
+          sink->set_gauge(opt_.metrics_prefix + "_ms", c.avg_ms, {{"encoding", std::string(c.name)}});
+      }
+
+      if (sink)
+        sink->set_gauge(opt_.metrics_prefix + "_cpu_ratio", cpu);
+    }
+
+  private:
+    AdaptiveCompressionOptions opt_;
+    mutable std::mutex mu_;
+    Codec codecs_[3];
+    std::int64_t last_adjust_ms_{0};
+  };
+
+} // namespace vix::middleware::performance
+
+#endif // VIX_ADAPTIVE_COMPRESSION_HPP
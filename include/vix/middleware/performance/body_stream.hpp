@@ -0,0 +1,837 @@
+/**
+ *
+ *  @file body_stream.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_BODY_STREAM_HPP
+#define VIX_BODY_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <vix/middleware/middleware.hpp>
+#include <vix/middleware/performance/compression.hpp>
+#include <vix/middleware/performance/etag.hpp>
+#include <vix/middleware/utils/body.hpp>
+
+namespace vix::middleware::performance
+{
+  /**
+   * @brief One stage of a streamed response body.
+   *
+   * Stages are chained: each one transforms the bytes it receives and
+   * writes the result to the next stage.
+   */
+  class IBodySink
+  {
+  public:
+    virtual ~IBodySink() = default;
+
+    /** @brief Consume a chunk of body bytes. */
+    virtual bool write(std::string_view chunk) = 0;
+
+    /** @brief Push everything buffered so far downstream. */
+    virtual bool flush() = 0;
+
+    /** @brief Terminate the body. */
+    virtual bool finish() = 0;
+  };
+
+  /**
+   * @brief Connection hooks supplied by the server for streamed bodies.
+   */
+  struct BodyTransport
+  {
+    /**
+     * @brief Send the status line and headers (called once, before the
+     * first chunk).
+     */
+    std::function<bool(vix::http::Response &)> begin{};
+
+    /**
+     * @brief Send raw bytes, already framed as chunked transfer coding.
+     */
+    std::function<bool(std::string_view)> write{};
+
+    explicit operator bool() const noexcept { return static_cast<bool>(write); }
+  };
+
+  /**
+   * @brief Options for streaming().
+   */
+  struct StreamingOptions
+  {
+    /**
+     * @brief Encode the stream with the negotiated coding.
+     */
+    bool compress{true};
+
+    /**
+     * @brief Negotiation, levels and Content-Type policy.
+     *
+     * min_size, sample_bytes, executor and memo do not apply: the size and
+     * content of a stream are unknown when its headers go out.
+     */
+    CompressionOptions compression{};
+
+    /**
+     * @brief Hash the body and emit an ETag (as a trailer when chunked).
+     */
+    bool etag{true};
+    bool weak_etag{true};
+
+    /**
+     * @brief Encoded bytes staged before a chunk is emitted.
+     */
+    std::size_t chunk_size{16 * 1024};
+
+    /**
+     * @brief Identity bytes kept for http_cache() (0 = off).
+     *
+     * Bodies up to this size are copied aside as they stream, so the
+     * cache can store them. Larger ones are dropped from the tee and are
+     * not cached.
+     */
+    std::size_t tee_max_bytes{0};
+
+    /**
+     * @brief Connection hooks for the current request.
+     *
+     * When unset (or returning an empty transport), the stream is
+     * collected into the response body and sent by the server as usual:
+     * the same API, without the memory and time-to-first-byte savings.
+     */
+    std::function<BodyTransport(Context &)> transport{};
+  };
+
+  /**
+   * @brief Collects the body into a string (buffered fallback).
+   */
+  class StringSink final : public IBodySink
+  {
+  public:
+    explicit StringSink(std::string &out) : out_(out) {}
+
+    bool write(std::string_view chunk) override
+    {
+      out_.append(chunk.data(), chunk.size());
+      return true;
+    }
+
+    bool flush() override { return true; }
+    bool finish() override { return true; }
+
+  private:
+    std::string &out_;
+  };
+
+  /**
+   * @brief HTTP/1.1 chunked transfer coding over a transport.
+   */
+  class ChunkedSink final : public IBodySink
+  {
+  public:
+    explicit ChunkedSink(std::function<bool(std::string_view)> write)
+        : write_(std::move(write))
+    {
+    }
+
+    /**
+     * @brief Trailer fields sent after the last chunk.
+     *
+     * @param trailers "Name: value\r\n" lines.
+     */
+    void set_trailers(std::string trailers) { trailers_ = std::move(trailers); }
+
+    bool write(std::string_view chunk) override
+    {
+      // A zero-length chunk would terminate the body.
+      if (chunk.empty())
+        return true;
+
+      frame_.clear();
+      append_hex_(frame_, chunk.size());
+      frame_ += "\r\n";
+      frame_.append(chunk.data(), chunk.size());
+      frame_ += "\r\n";
+      return write_(frame_);
+    }
+
+    bool flush() override { return true; }
+
+    bool finish() override
+    {
+      frame_ = "0\r\n";
+      frame_ += trailers_;
+      frame_ += "\r\n";
+      return write_(frame_);
+    }
+
+  private:
+    static void append_hex_(std::string &out, std::size_t n)
+    {
+      static const char *hex = "0123456789abcdef";
+      char tmp[2 * sizeof(std::size_t)];
+      std::size_t len = 0;
+
+      do
+      {
+        tmp[len++] = hex[n & 0xF];
+        n >>= 4;
+      } while (n != 0);
+
+      while (len > 0)
+        out.push_back(tmp[--len]);
+    }
+
+  private:
+    std::function<bool(std::string_view)> write_;
+    std::string trailers_{};
+    std::string frame_{};
+  };
+
+  /**
+   * @brief Base of the incremental encoders.
+   *
+   * Encoded output is staged in a chunk_size buffer and handed to the next
+   * stage when the buffer fills up, on flush() and on finish(), so a
+   * stream costs one buffer plus the codec state whatever its length.
+   */
+  class EncoderSink : public IBodySink
+  {
+  protected:
+    EncoderSink(IBodySink &next, std::size_t chunk_size)
+        : next_(next),
+          buf_(chunk_size ? chunk_size : 16 * 1024, '\0')
+    {
+    }
+
+    /**
+     * @brief Emit the staged bytes when the buffer is full, or when
+     * @p all is set and anything is staged.
+     */
+    bool drain_(bool all)
+    {
+      if (used_ == 0 || (!all && used_ < buf_.size()))
+        return true;
+
+      const std::size_t n = used_;
+      used_ = 0;
+      return next_.write(std::string_view(buf_.data(), n));
+    }
+
+    /** @brief Largest input handed to the codec in one call. */
+    static constexpr std::size_t k_max_step = std::size_t{1} << 30;
+
+    IBodySink &next_;
+    std::string buf_;
+    std::size_t used_{0};
+  };
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  /**
+   * @brief Incremental gzip encoder (one gzip member per stream).
+   */
+  class GzipStreamSink final : public EncoderSink
+  {
+  public:
+    GzipStreamSink(IBodySink &next, int level, std::size_t chunk_size)
+        : EncoderSink(next, chunk_size)
+    {
+      const int lvl = (level < 1) ? 1 : (level > 9 ? 9 : level);
+      ok_ = deflateInit2(&zs_, lvl, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~GzipStreamSink() override
+    {
+      if (ok_)
+        deflateEnd(&zs_);
+    }
+
+    GzipStreamSink(const GzipStreamSink &) = delete;
+    GzipStreamSink &operator=(const GzipStreamSink &) = delete;
+
+    bool valid() const noexcept { return ok_; }
+
+    bool write(std::string_view chunk) override
+    {
+      while (!chunk.empty())
+      {
+        const std::size_t n = chunk.size() < k_max_step ? chunk.size() : k_max_step;
+        if (!pump_(chunk.substr(0, n), Z_NO_FLUSH))
+          return false;
+        chunk.remove_prefix(n);
+      }
+      return true;
+    }
+
+    bool flush() override { return pump_({}, Z_SYNC_FLUSH) && next_.flush(); }
+    bool finish() override { return pump_({}, Z_FINISH) && next_.finish(); }
+
+  private:
+    bool pump_(std::string_view in, int mode)
+    {
+      if (!ok_)
+        return false;
+
+      zs_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+      zs_.avail_in = static_cast<uInt>(in.size());
+
+      for (;;)
+      {
+        zs_.next_out = reinterpret_cast<Bytef *>(buf_.data() + used_);
+        zs_.avail_out = static_cast<uInt>(buf_.size() - used_);
+
+        const int rc = deflate(&zs_, mode);
+        if (rc == Z_STREAM_ERROR)
+          return false;
+
+        const bool room_left = zs_.avail_out != 0;
+        used_ = buf_.size() - zs_.avail_out;
+        if (!drain_(false))
+          return false;
+
+        // Z_BUF_ERROR: nothing left to do for this call.
+        const bool done = (mode == Z_FINISH) ? rc == Z_STREAM_END
+                                             : (zs_.avail_in == 0 && (mode == Z_NO_FLUSH || room_left || rc == Z_BUF_ERROR));
+        if (done)
+          break;
+      }
+
+      return mode == Z_NO_FLUSH || drain_(true);
+    }
+
+  private:
+    z_stream zs_{};
+    bool ok_{false};
+  };
+#endif
+
+#if defined(VIX_HAS_BROTLI) && VIX_HAS_BROTLI
+  /**
+   * @brief Incremental Brotli encoder.
+   */
+  class BrotliStreamSink final : public EncoderSink
+  {
+  public:
+    BrotliStreamSink(IBodySink &next, int quality, std::size_t chunk_size)
+        : EncoderSink(next, chunk_size),
+          st_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr))
+    {
+      const int q = (quality < 0) ? 0 : (quality > 11 ? 11 : quality);
+      if (st_)
+        BrotliEncoderSetParameter(st_, BROTLI_PARAM_QUALITY, static_cast<uint32_t>(q));
+    }
+
+    ~BrotliStreamSink() override
+    {
+      if (st_)
+        BrotliEncoderDestroyInstance(st_);
+    }
+
+    BrotliStreamSink(const BrotliStreamSink &) = delete;
+    BrotliStreamSink &operator=(const BrotliStreamSink &) = delete;
+
+    bool valid() const noexcept { return st_ != nullptr; }
+
+    bool write(std::string_view chunk) override
+    {
+      return chunk.empty() || pump_(chunk, BROTLI_OPERATION_PROCESS);
+    }
+
+    bool flush() override { return pump_({}, BROTLI_OPERATION_FLUSH) && next_.flush(); }
+    bool finish() override { return pump_({}, BROTLI_OPERATION_FINISH) && next_.finish(); }
+
+  private:
+    bool pump_(std::string_view in, BrotliEncoderOperation op)
+    {
+      if (!st_)
+        return false;
+
+      const uint8_t *next_in = reinterpret_cast<const uint8_t *>(in.data());
+      size_t avail_in = in.size();
+
+      for (;;)
+      {
+        uint8_t *next_out = reinterpret_cast<uint8_t *>(buf_.data() + used_);
+        size_t avail_out = buf_.size() - used_;
+
+        if (!BrotliEncoderCompressStream(st_, op, &avail_in, &next_in, &avail_out, &next_out, nullptr))
+          return false;
+
+        used_ = buf_.size() - avail_out;
+        if (!drain_(false))
+          return false;
+
+        const bool done = (op == BROTLI_OPERATION_FINISH)
+                              ? BrotliEncoderIsFinished(st_) != 0
+                              : (avail_in == 0 && !BrotliEncoderHasMoreOutput(st_));
+        if (done)
+          break;
+      }
+
+      return op == BROTLI_OPERATION_PROCESS || drain_(true);
+    }
+
+  private:
+    BrotliEncoderState *st_{nullptr};
+  };
+#endif
+
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+  /**
+   * @brief Incremental zstd encoder (one frame per stream).
+   */
+  class ZstdStreamSink final : public EncoderSink
+  {
+  public:
+    ZstdStreamSink(IBodySink &next, int level, std::size_t chunk_size)
+        : EncoderSink(next, chunk_size),
+          cctx_(ZSTD_createCCtx())
+    {
+      const int lvl = (level < 1) ? 1 : (level > 19 ? 19 : level);
+      if (cctx_ && ZSTD_isError(ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, lvl)))
+      {
+        ZSTD_freeCCtx(cctx_);
+        cctx_ = nullptr;
+      }
+    }
+
+    ~ZstdStreamSink() override { ZSTD_freeCCtx(cctx_); }
+
+    ZstdStreamSink(const ZstdStreamSink &) = delete;
+    ZstdStreamSink &operator=(const ZstdStreamSink &) = delete;
+
+    bool valid() const noexcept { return cctx_ != nullptr; }
+
+    bool write(std::string_view chunk) override
+    {
+      return chunk.empty() || pump_(chunk, ZSTD_e_continue);
+    }
+
+    bool flush() override { return pump_({}, ZSTD_e_flush) && next_.flush(); }
+    bool finish() override { return pump_({}, ZSTD_e_end) && next_.finish(); }
+
+  private:
+    bool pump_(std::string_view in, ZSTD_EndDirective mode)
+    {
+      if (!cctx_)
+        return false;
+
+      ZSTD_inBuffer ib{in.data(), in.size(), 0};
+
+      for (;;)
+      {
+        ZSTD_outBuffer ob{buf_.data() + used_, buf_.size() - used_, 0};
+
+        const std::size_t remaining = ZSTD_compressStream2(cctx_, &ob, &ib, mode);
+        if (ZSTD_isError(remaining))
+          return false;
+
+        used_ += ob.pos;
+        if (!drain_(false))
+          return false;
+
+        const bool done = (mode == ZSTD_e_continue) ? ib.pos == ib.size : remaining == 0;
+        if (done)
+          break;
+      }
+
+      return mode == ZSTD_e_continue || drain_(true);
+    }
+
+  private:
+    ZSTD_CCtx *cctx_{nullptr};
+  };
+#endif
+
+  /**
+   * @brief Incremental encoder for a content coding.
+   *
+   * @return The encoder, or nullptr if the coding is unknown, not compiled
+   * in, or its state could not be allocated.
+   */
+  inline std::unique_ptr<IBodySink> make_encoder_sink(
+      [[maybe_unused]] std::string_view encoding,
+      [[maybe_unused]] IBodySink &next,
+      [[maybe_unused]] int level,
+      [[maybe_unused]] std::size_t chunk_size)
+  {
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+    if (encoding == "zstd")
+    {
+      auto s = std::make_unique<ZstdStreamSink>(next, level, chunk_size);
+      return s->valid() ? std::move(s) : nullptr;
+    }
+#endif
+
+#if defined(VIX_HAS_BROTLI) && VIX_HAS_BROTLI
+    if (encoding == "br")
+    {
+      auto s = std::make_unique<BrotliStreamSink>(next, level, chunk_size);
+      return s->valid() ? std::move(s) : nullptr;
+    }
+#endif
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+    if (encoding == "gzip")
+    {
+      auto s = std::make_unique<GzipStreamSink>(next, level, chunk_size);
+      return s->valid() ? std::move(s) : nullptr;
+    }
+#endif
+
+    return nullptr;
+  }
+
+  /**
+   * @brief Response body written by the handler in chunks.
+   *
+   * The first write() (or flush()) commits the headers: the coding is
+   * negotiated from Accept-Encoding and the response's status and
+   * Content-Type, then each chunk goes through
+   * - the ETag hash and the cache tee (identity bytes)
+   * - the incremental encoder, when a coding was picked
+   * - chunked framing to the transport, or the buffered fallback
+   *
+   * end() terminates the body. 2xx responses get an ETag: with a
+   * transport it is sent as a trailer (announced by "Trailer: ETag");
+   * buffered, it is a header and a matching If-None-Match turns the
+   * response into a 304.
+   *
+   * Not thread-safe: one stream belongs to one request.
+   */
+  class BodyStream final
+  {
+  public:
+    BodyStream(Context &ctx,
+               std::shared_ptr<const StreamingOptions> opt,
+               BodyTransport transport = {})
+        : req_(ctx.req()),
+          res_(ctx.res()),
+          opt_(std::move(opt)),
+          transport_(std::move(transport)),
+          accept_(req_.header("accept-encoding")),
+          if_none_match_(req_.header("if-none-match")),
+          head_(req_.method() == "HEAD")
+    {
+    }
+
+    BodyStream(const BodyStream &) = delete;
+    BodyStream &operator=(const BodyStream &) = delete;
+
+    /**
+     * @brief Append a chunk to the body.
+     *
+     * Set status and headers before the first call; they are committed
+     * then.
+     *
+     * @return false once the stream has failed or ended.
+     */
+    bool write(std::string_view chunk)
+    {
+      if (finished_ || !begin_())
+        return false;
+
+      if (chunk.empty())
+        return true;
+
+      bytes_in_ += chunk.size();
+
+      if (tagged_)
+        hash_ = fnv1a_64_update(hash_, chunk);
+
+      tee_(chunk);
+
+      if (head_)
+        return true;
+
+      return check_(sink_->write(chunk));
+    }
+
+    /**
+     * @brief Send everything written so far (encoder flush included).
+     *
+     * Commits the headers when nothing was written yet.
+     */
+    bool flush()
+    {
+      if (finished_ || !begin_())
+        return false;
+
+      return head_ || check_(sink_->flush());
+    }
+
+    /**
+     * @brief Terminate the body. Idempotent.
+     *
+     * streaming() calls it after the handler returns if the handler did
+     * not.
+     */
+    bool end()
+    {
+      if (finished_)
+        return !failed_;
+
+      const bool ok = begin_();
+      finished_ = true;
+      if (!ok)
+        return false;
+
+      // Buffered, the handler may still have changed the status.
+      if (!chunked_ && !is_taggable_status_(res_.res.status()))
+        tagged_ = false;
+
+      if (tagged_)
+      {
+        etag_ = "\"" + to_hex_u64(hash_) + "\"";
+        if (opt_->weak_etag)
+          etag_ = "W/" + etag_;
+      }
+
+      if (chunked_)
+      {
+        if (head_)
+          return true;
+
+        if (!etag_.empty())
+          chunked_->set_trailers("ETag: " + etag_ + "\r\n");
+
+        return check_(sink_->finish());
+      }
+
+      if (!check_(sink_->finish()))
+        return false;
+
+      if (!etag_.empty())
+      {
+        res_.header("ETag", etag_);
+
+        if (!if_none_match_.empty() && if_none_match_ == etag_)
+        {
+          res_.status(304);
+          buffer_.clear();
+        }
+      }
+
+      vix::middleware::utils::replace_body(res_.res, std::move(buffer_));
+      return true;
+    }
+
+    bool started() const noexcept { return started_; }
+    bool finished() const noexcept { return finished_; }
+    bool failed() const noexcept { return failed_; }
+
+    /** @brief True when bytes go to the transport as chunked transfer. */
+    bool chunked() const noexcept { return chunked_ != nullptr; }
+
+    /** @brief Coding applied to the stream ("" for identity). */
+    const std::string &encoding() const noexcept { return encoding_; }
+
+    /** @brief ETag of the identity body (set by end() for 2xx responses). */
+    const std::string &etag() const noexcept { return etag_; }
+
+    /** @brief Identity bytes written so far. */
+    std::uint64_t bytes_in() const noexcept { return bytes_in_; }
+
+    /**
+     * @brief The whole identity body, for caching.
+     *
+     * @return nullptr unless the stream ended cleanly and fit in
+     * tee_max_bytes.
+     */
+    const std::string *tee() const noexcept
+    {
+      if (!finished_ || failed_ || opt_->tee_max_bytes == 0 || tee_dropped_)
+        return nullptr;
+      return &tee_body_;
+    }
+
+  private:
+    /** @brief Commit the headers and build the chain on first use. */
+    bool begin_()
+    {
+      if (started_)
+        return !failed_;
+
+      started_ = true;
+      req_.emplace_state<vix::middleware::utils::StreamedBody>(vix::middleware::utils::StreamedBody{});
+
+      auto &raw = res_.res;
+      const CompressionOptions &copt = opt_->compression;
+
+      tagged_ = opt_->etag && is_taggable_status_(raw.status());
+
+      if (opt_->compress && copt.enabled)
+      {
+        if (copt.add_vary)
+          add_vary_accept_encoding(res_);
+
+        if (is_compressible_status(raw.status()) &&
+            !response_already_encoded(res_) &&
+            !is_partial_response(res_) &&
+            is_compressible_type(raw.header("Content-Type"), copt))
+        {
+          encoding_ = negotiate_encoding(accept_, copt);
+        }
+      }
+
+      if (transport_)
+      {
+        auto chunked = std::make_unique<ChunkedSink>(transport_.write);
+        chunked_ = chunked.get();
+        terminal_ = std::move(chunked);
+
+        res_.header("Transfer-Encoding", "chunked");
+        if (tagged_)
+          res_.header("Trailer", "ETag");
+      }
+      else
+      {
+        terminal_ = std::make_unique<StringSink>(buffer_);
+      }
+
+      sink_ = terminal_.get();
+
+      if (!encoding_.empty())
+      {
+        encoder_ = make_encoder_sink(encoding_, *terminal_, compression_level(encoding_, copt), opt_->chunk_size);
+        if (encoder_)
+        {
+          sink_ = encoder_.get();
+          res_.header("Content-Encoding", encoding_);
+        }
+        else
+        {
+          encoding_.clear();
+        }
+      }
+
+      if (transport_ && transport_.begin && !transport_.begin(raw))
+        failed_ = true;
+
+      return !failed_;
+    }
+
+    /** @brief Same rule as etag(): only 2xx responses are tagged. */
+    static bool is_taggable_status_(int code) { return code >= 200 && code < 300; }
+
+    void tee_(std::string_view chunk)
+    {
+      if (opt_->tee_max_bytes == 0 || tee_dropped_)
+        return;
+
+      if (tee_body_.size() + chunk.size() > opt_->tee_max_bytes)
+      {
+        tee_dropped_ = true;
+        std::string().swap(tee_body_);
+        return;
+      }
+
+      tee_body_.append(chunk.data(), chunk.size());
+    }
+
+    bool check_(bool ok)
+    {
+      if (!ok)
+        failed_ = true;
+      return ok;
+    }
+
+  private:
+    Request &req_;
+    Response &res_;
+    std::shared_ptr<const StreamingOptions> opt_;
+    BodyTransport transport_;
+
+    std::string accept_;
+    std::string if_none_match_;
+    bool head_{false};
+
+    bool started_{false};
+    bool finished_{false};
+    bool failed_{false};
+
+    std::string encoding_{};
+    std::unique_ptr<IBodySink> terminal_{};
+    std::unique_ptr<IBodySink> encoder_{};
+    ChunkedSink *chunked_{nullptr};
+    IBodySink *sink_{nullptr};
+    std::string buffer_{};
+
+    bool tagged_{false};
+    std::uint64_t hash_{fnv1a_64_basis};
+    std::uint64_t bytes_in_{0};
+    std::string etag_{};
+
+    std::string tee_body_{};
+    bool tee_dropped_{false};
+  };
+
+  /**
+   * @brief Request state holding the request's BodyStream.
+   */
+  struct BodyStreamState
+  {
+    std::shared_ptr<BodyStream> stream{};
+  };
+
+  /**
+   * @brief The BodyStream of the current request.
+   *
+   * @return nullptr when streaming() is not installed.
+   */
+  inline BodyStream *body_stream(Request &req)
+  {
+    auto *st = req.try_state<BodyStreamState>();
+    return st ? st->stream.get() : nullptr;
+  }
+
+  /**
+   * @brief Streaming response body middleware.
+   *
+   * Gives each request a BodyStream (see body_stream()). Handlers that
+   * produce large bodies write them in chunks instead of setting a
+   * buffered body; encoding, ETag hashing and the cache tee run chunk by
+   * chunk. Handlers that never touch the stream are unaffected, and
+   * compression(), etag() and http_cache() keep post-processing them.
+   *
+   * Install it after compression(), etag() and http_cache(), so the stream
+   * has ended before they inspect the response.
+   *
+   * @param opt Streaming options.
+   * @return A middleware function (MiddlewareFn).
+   */
+  inline MiddlewareFn streaming(StreamingOptions opt = {})
+  {
+    auto shared = std::make_shared<const StreamingOptions>(std::move(opt));
+
+    return [shared](Context &ctx, Next next)
+    {
+      BodyTransport transport = shared->transport ? shared->transport(ctx) : BodyTransport{};
+      auto stream = std::make_shared<BodyStream>(ctx, shared, std::move(transport));
+
+      ctx.req().emplace_state<BodyStreamState>(BodyStreamState{stream});
+
+      next();
+
+      if (stream->started())
+        stream->end();
+    };
+  }
+
+} // namespace vix::middleware::performance
+
+#endif // VIX_BODY_STREAM_HPP
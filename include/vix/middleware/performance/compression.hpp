@@ -13,12 +13,28 @@
 #ifndef VIX_COMPRESSION_HPP
 #define VIX_COMPRESSION_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
+#include <vix/executor/IExecutor.hpp>
 #include <vix/middleware/middleware.hpp>
+#include <vix/middleware/performance/adaptive_compression.hpp>
+#include <vix/middleware/performance/compression_memo.hpp>
+#include <vix/middleware/utils/body.hpp>
 
 #ifndef VIX_HAS_ZLIB
 #define VIX_HAS_ZLIB 0
@@ -28,10 +44,15 @@
 #define VIX_HAS_BROTLI 0
 #endif
 
+#ifndef VIX_HAS_ZSTD
+#define VIX_HAS_ZSTD 0
+#endif
+
 /**
  * Enable these in your build if libs are available:
  * -DVIX_HAS_ZLIB=1   (and link -lz)
  * -DVIX_HAS_BROTLI=1 (and link -lbrotlienc -lbrotlicommon)
+ * -DVIX_HAS_ZSTD=1   (and link -lzstd)
  */
 #if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
 #include <zlib.h>
@@ -41,6 +62,10 @@
 #include <brotli/encode.h>
 #endif
 
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+#include <zstd.h>
+#endif
+
 namespace vix::middleware::performance
 {
   /**
@@ -77,6 +102,115 @@ namespace vix::middleware::performance
      * @brief Gzip compression level (1..9).
      */
     int gzip_level{6};
+
+    /**
+     * @brief Prefer zstd when the client rates it as high as br/gzip.
+     *
+     * zstd compresses about as well as gzip at a fraction of the CPU cost.
+     */
+    bool prefer_zstd{true};
+
+    /**
+     * @brief Zstandard compression level (1..19).
+     */
+    int zstd_level{3};
+
+    /**
+     * @brief Executor used to compress large bodies in parallel (nullptr = off).
+     *
+     * Bodies of at least parallel_min_size bytes are split into
+     * parallel_block_size blocks compressed concurrently (gzip and zstd).
+     */
+    vix::executor::IExecutor *executor{nullptr};
+
+    /**
+     * @brief Body size from which the parallel mode is used.
+     */
+    std::size_t parallel_min_size{1024 * 1024};
+
+    /**
+     * @brief Uncompressed bytes per parallel block.
+     */
+    std::size_t parallel_block_size{128 * 1024};
+
+    /**
+     * @brief Adaptive level controller (nullptr = fixed levels).
+     *
+     * When set, the gzip/br/zstd levels come from the controller, which
+     * tunes them within its bounds to hold a per-response time budget.
+     */
+    std::shared_ptr<AdaptiveCompression> adaptive{};
+
+    /**
+     * @brief Memo of compressed outputs (nullptr = off).
+     *
+     * Repeated byte-identical bodies reuse the bytes compressed the first
+     * time instead of running the codec again.
+     */
+    std::shared_ptr<CompressionMemo> memo{};
+
+    /**
+     * @brief Media types worth compressing (empty = every type not skipped).
+     *
+     * Entries match the Content-Type without parameters:
+     * - "text/" matches the whole top-level type (prefix ending in '/')
+     * - "+json" matches a structured syntax suffix (leading '+')
+     * - anything else must match exactly
+     */
+    std::vector<std::string> compress_types{
+        "text/",
+        "application/json",
+        "application/javascript",
+        "application/xml",
+        "application/wasm",
+        "image/svg+xml",
+        "image/x-icon",
+        "font/ttf",
+        "font/otf",
+        "+json",
+        "+xml",
+    };
+
+    /**
+     * @brief Media types never compressed (checked before compress_types).
+     *
+     * Defaults cover formats that are already compressed.
+     */
+    std::vector<std::string> skip_types{
+        "image/png",
+        "image/jpeg",
+        "image/gif",
+        "image/webp",
+        "image/avif",
+        "video/",
+        "audio/",
+        "font/woff",
+        "font/woff2",
+        "application/zip",
+        "application/gzip",
+        "application/x-gzip",
+        "application/zstd",
+        "application/x-7z-compressed",
+        "application/pdf",
+    };
+
+    /**
+     * @brief Compress responses without a Content-Type.
+     */
+    bool compress_untyped{true};
+
+    /**
+     * @brief Bytes sampled from the start of the body to estimate its
+     * compressibility (0 disables sampling).
+     *
+     * A few KB are enough to spot random or already-compressed payloads.
+     */
+    std::size_t sample_bytes{0};
+
+    /**
+     * @brief Minimum estimated size reduction (0..1) when sampling is on.
+     */
+    double min_gain{0.05};
   };
 
   /**
@@ -123,62 +257,486 @@ namespace vix::middleware::performance
   }
 
   /**
-   * @brief Check whether an Accept-Encoding token is allowed.
+   * @brief One entry of an Accept-Encoding header.
+   */
+  struct AcceptCoding
+  {
+    std::string coding; ///< lower-cased coding ("gzip", "br", "*", ...)
+    double q{1.0};      ///< client preference (0..1), 0 means "not acceptable"
+  };
+
+  /**
+   * @brief Parse an RFC 9110 qvalue ("0", "0.8", "1.000").
    *
-   * This is a tiny heuristic:
-   * - token must appear in the header
-   * - if "token;q=0" or "token; q=0" appears, it is treated as disabled
+   * @param v The value after "q=".
+   * @param out Parsed weight.
+   * @return false if @p v is not a valid qvalue.
+   */
+  inline bool parse_qvalue(std::string_view v, double &out)
+  {
+    if (v.empty() || (v[0] != '0' && v[0] != '1'))
+      return false;
+
+    const bool one = (v[0] == '1');
+    double q = one ? 1.0 : 0.0;
+
+    if (v.size() > 1)
+    {
+      if (v[1] != '.' || v.size() > 5)
+        return false;
+
+      double scale = 0.1;
+      for (std::size_t i = 2; i < v.size(); ++i)
+      {
+        const char c = v[i];
+        if (c < '0' || c > '9' || (one && c != '0'))
+          return false;
+        q += (c - '0') * scale;
+        scale /= 10.0;
+      }
+    }
+
+    out = q;
+    return true;
+  }
+
+  /**
+   * @brief Parse an Accept-Encoding header into codings and weights.
    *
-   * This is not a full RFC parser, but it handles common cases well enough.
+   * Handles "coding;q=0.5" lists with arbitrary whitespace and case.
+   * Entries with a malformed qvalue are dropped. "x-gzip" is folded
+   * into "gzip".
+   *
+   * @param accept The "Accept-Encoding" header value.
+   * @return Entries in header order.
+   */
+  inline std::vector<AcceptCoding> parse_accept_encoding(std::string_view accept)
+  {
+    auto trim = [](std::string_view v)
+    {
+      while (!v.empty() && (v.front() == ' ' || v.front() == '\t'))
+        v.remove_prefix(1);
+      while (!v.empty() && (v.back() == ' ' || v.back() == '\t'))
+        v.remove_suffix(1);
+      return v;
+    };
+
+    std::vector<AcceptCoding> out;
+
+    while (!accept.empty())
+    {
+      const std::size_t comma = accept.find(',');
+      std::string_view item = accept.substr(0, comma);
+      accept = (comma == std::string_view::npos) ? std::string_view{} : accept.substr(comma + 1);
+
+      const std::size_t semi = item.find(';');
+      const std::string_view name = trim(item.substr(0, semi));
+      if (name.empty())
+        continue;
+
+      AcceptCoding ac;
+      ac.coding.reserve(name.size());
+      for (char c : name)
+        ac.coding.push_back((c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c);
+      if (ac.coding == "x-gzip")
+        ac.coding = "gzip";
+
+      bool valid = true;
+      std::string_view params = (semi == std::string_view::npos) ? std::string_view{} : item.substr(semi + 1);
+      while (!params.empty())
+      {
+        const std::size_t next = params.find(';');
+        const std::string_view param = trim(params.substr(0, next));
+        params = (next == std::string_view::npos) ? std::string_view{} : params.substr(next + 1);
+
+        if (param.size() >= 2 && icase_eq(param[0], 'q') && param.find('=') != std::string_view::npos)
+        {
+          const std::size_t eq = param.find('=');
+          if (trim(param.substr(0, eq)).size() != 1 || !parse_qvalue(trim(param.substr(eq + 1)), ac.q))
+            valid = false;
+        }
+      }
+
+      if (valid)
+        out.push_back(std::move(ac));
+    }
+
+    return out;
+  }
+
+  /**
+   * @brief Weight the client gives to a coding.
+   *
+   * An explicit entry wins over "*". "identity" is acceptable unless
+   * excluded explicitly or through "*;q=0".
+   *
+   * @param list Parsed Accept-Encoding entries.
+   * @param coding Lower-case coding name.
+   * @return The weight (0 when not acceptable).
+   */
+  inline double accepted_q(const std::vector<AcceptCoding> &list, std::string_view coding)
+  {
+    const AcceptCoding *wildcard = nullptr;
+
+    for (const auto &ac : list)
+    {
+      if (ac.coding == coding)
+        return ac.q;
+      if (ac.coding == "*")
+        wildcard = &ac;
+    }
+
+    if (wildcard)
+      return wildcard->q;
+
+    return coding == "identity" ? 1.0 : 0.0;
+  }
+
+  /**
+   * @brief Check whether an Accept-Encoding token is allowed.
    *
    * @param accept The "Accept-Encoding" header value.
    * @param token Encoding token (e.g. "gzip", "br").
-   * @return true if token is accepted and not explicitly disabled via q=0.
+   * @return true if the client gives @p token a non-zero weight.
    */
   inline bool token_allowed(std::string_view accept, std::string_view token)
   {
-    if (!contains_token_icase(accept, token))
+    std::string lower(token);
+    for (auto &c : lower)
+      c = (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+
+    return accepted_q(parse_accept_encoding(accept), lower) > 0.0;
+  }
+
+  /**
+   * @brief Run fn(0) .. fn(n - 1) on an executor and the calling thread.
+   *
+   * Blocks are claimed from a shared cursor, and the caller claims blocks
+   * too instead of only waiting. Progress is therefore guaranteed even
+   * when the caller is itself a worker of a saturated @p ex, and jobs
+   * that start after all blocks are taken return immediately.
+   *
+   * @param ex Executor (nullptr runs everything on the caller).
+   * @param n Number of blocks.
+   * @param fn Block function, returns false on failure.
+   * @return true if every block succeeded.
+   */
+  inline bool run_blocks(
+      vix::executor::IExecutor *ex,
+      std::size_t n,
+      const std::function<bool(std::size_t)> &fn)
+  {
+    struct State
+    {
+      std::atomic<std::size_t> next{0};
+      std::atomic<bool> ok{true};
+      std::mutex mu;
+      std::condition_variable cv;
+      std::size_t done{0};
+    };
+
+    auto st = std::make_shared<State>();
+
+    // Only dereferences fn after claiming a block, i.e. while the caller
+    // is still waiting in this function.
+    auto work = [st, n, fnp = &fn]()
+    {
+      for (;;)
+      {
+        const std::size_t i = st->next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= n)
+          return;
+
+        bool ok = false;
+        try
+        {
+          ok = (*fnp)(i);
+        }
+        catch (...)
+        {
+        }
+
+        if (!ok)
+          st->ok.store(false, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(st->mu);
+        if (++st->done == n)
+          st->cv.notify_all();
+      }
+    };
+
+    if (ex)
+    {
+      for (std::size_t i = 1; i < n; ++i)
+      {
+        if (!ex->post(work))
+          break;
+      }
+    }
+
+    work();
+
+    std::unique_lock<std::mutex> lock(st->mu);
+    st->cv.wait(lock, [&]()
+                { return st->done == n; });
+
+    return st->ok.load(std::memory_order_relaxed);
+  }
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  /**
+   * @brief Per-thread deflate streams, one gzip-wrapped and one raw.
+   *
+   * deflateInit2 allocates about 256KB of state, so a thread keeps at most
+   * two. Streams are created on first use, recycled with deflateReset,
+   * switched to the requested level with deflateParams, and released at
+   * thread exit.
+   */
+  class GzipContexts final
+  {
+  public:
+    GzipContexts() = default;
+    GzipContexts(const GzipContexts &) = delete;
+    GzipContexts &operator=(const GzipContexts &) = delete;
+
+    ~GzipContexts()
+    {
+      for (auto &s : streams_)
+      {
+        if (s.ready)
+          deflateEnd(&s.zs);
+      }
+    }
+
+    /** @brief Calling thread's contexts. */
+    static GzipContexts &local()
+    {
+      thread_local GzipContexts ctx;
+      return ctx;
+    }
+
+    /**
+     * @brief Reset stream for @p level (1..9), or nullptr on failure.
+     *
+     * @param raw true for a raw deflate stream (no gzip header/trailer).
+     */
+    z_stream *acquire(int level, bool raw = false)
+    {
+      Stream &s = streams_[raw ? 1 : 0];
+
+      // A freshly reset stream has no pending input, so deflateParams
+      // only switches the level.
+      if (s.ready && deflateReset(&s.zs) == Z_OK &&
+          (s.level == level || deflateParams(&s.zs, level, Z_DEFAULT_STRATEGY) == Z_OK))
+      {
+        s.level = level;
+        return &s.zs;
+      }
+
+      if (s.ready)
+      {
+        deflateEnd(&s.zs);
+        s.ready = false;
+      }
+
+      s.zs = z_stream{};
+      s.zs.zalloc = Z_NULL;
+      s.zs.zfree = Z_NULL;
+      s.zs.opaque = Z_NULL;
+
+      if (deflateInit2(&s.zs, level, Z_DEFLATED, raw ? -15 : 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return nullptr;
+
+      s.ready = true;
+      s.level = level;
+      return &s.zs;
+    }
+
+  private:
+    struct Stream
+    {
+      z_stream zs{};
+      int level{0};
+      bool ready{false};
+    };
+
+    Stream streams_[2]{};
+  };
+
+  /**
+   * @brief Compress data with gzip using zlib.
+   *
+   * Uses the calling thread's deflate stream for the level (windowBits=15+16
+   * for the gzip header/trailer) and deflates in one call straight into
+   * an output sized with deflateBound.
+   *
+   * @param input Input data.
+   * @param out Output buffer (written on success).
+   * @param level Gzip level (1..9).
+   * @return true on success.
+   */
+  inline bool gzip_compress(std::string_view input, std::string &out, int level)
+  {
+    const int lvl = (level < 1) ? 1 : (level > 9 ? 9 : level);
+
+    if (input.size() > std::numeric_limits<uInt>::max())
       return false;
 
-    const std::string pat = std::string(token) + ";q=0";
-    if (contains_token_icase(accept, pat))
+    z_stream *zs = GzipContexts::local().acquire(lvl);
+    if (!zs)
       return false;
 
-    const std::string pat2 = std::string(token) + "; q=0";
-    if (contains_token_icase(accept, pat2))
+    out.resize(deflateBound(zs, static_cast<uLong>(input.size())));
+
+    zs->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+    zs->avail_in = static_cast<uInt>(input.size());
+    zs->next_out = reinterpret_cast<Bytef *>(out.data());
+    zs->avail_out = static_cast<uInt>(out.size());
+
+    if (deflate(zs, Z_FINISH) != Z_STREAM_END)
+    {
+      out.clear();
       return false;
+    }
 
+    out.resize(out.size() - zs->avail_out);
     return true;
   }
 
-#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
   /**
-   * @brief Compress data with gzip using zlib.
+   * @brief Compress data with gzip, blocks deflated in parallel (pigz style).
    *
-   * Uses deflateInit2 with windowBits=15+16 to generate gzip header/trailer.
+   * Each block is raw-deflated with the 32KB preceding it as dictionary
+   * and ends on a sync flush (byte aligned), so the blocks concatenate
+   * into one deflate stream. Block CRCs are merged with crc32_combine.
+   * The result is a single regular gzip member, and the ratio stays
+   * close to the serial one.
    *
    * @param input Input data.
    * @param out Output buffer (written on success).
    * @param level Gzip level (1..9).
+   * @param ex Executor running the blocks (nullptr = caller only).
+   * @param block_size Uncompressed bytes per block.
    * @return true on success.
    */
-  inline bool gzip_compress(const std::string &input, std::string &out, int level)
+  inline bool gzip_compress_parallel(
+      std::string_view input,
+      std::string &out,
+      int level,
+      vix::executor::IExecutor *ex,
+      std::size_t block_size)
+  {
+    const int lvl = (level < 1) ? 1 : (level > 9 ? 9 : level);
+    constexpr std::size_t window = 32 * 1024;
+
+    if (block_size < window)
+      block_size = window;
+    if (block_size > (std::size_t{1} << 30))
+      block_size = std::size_t{1} << 30;
+
+    const std::size_t n = input.empty() ? 1 : (input.size() + block_size - 1) / block_size;
+
+    std::vector<std::string> parts(n);
+    std::vector<uLong> crcs(n, 0);
+
+    const bool ok = run_blocks(
+        ex, n,
+        [&](std::size_t i)
+        {
+          const std::size_t begin = i * block_size;
+          const std::size_t len = std::min(block_size, input.size() - begin);
+          const bool last = (i + 1 == n);
+
+          z_stream *zs = GzipContexts::local().acquire(lvl, true);
+          if (!zs)
+            return false;
+
+          if (begin > 0)
+          {
+            const std::size_t dict = std::min(window, begin);
+            if (deflateSetDictionary(
+                    zs,
+                    reinterpret_cast<const Bytef *>(input.data() + begin - dict),
+                    static_cast<uInt>(dict)) != Z_OK)
+              return false;
+          }
+
+          const Bytef *in = reinterpret_cast<const Bytef *>(input.data() + begin);
+          crcs[i] = crc32(0L, in, static_cast<uInt>(len));
+
+          std::string &part = parts[i];
+          part.resize(deflateBound(zs, static_cast<uLong>(len)) + 16);
+
+          zs->next_in = const_cast<Bytef *>(in);
+          zs->avail_in = static_cast<uInt>(len);
+          zs->next_out = reinterpret_cast<Bytef *>(part.data());
+          zs->avail_out = static_cast<uInt>(part.size());
+
+          const int ret = deflate(zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+          if (last ? ret != Z_STREAM_END : (ret != Z_OK || zs->avail_in != 0 || zs->avail_out == 0))
+            return false;
+
+          part.resize(part.size() - zs->avail_out);
+          return true;
+        });
+
+    if (!ok)
+      return false;
+
+    std::size_t total = 18;
+    for (const auto &part : parts)
+      total += part.size();
+
+    out.clear();
+    out.reserve(total);
+
+    // Minimal gzip header: no name, no mtime, unknown OS.
+    static constexpr char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+    out.append(header, sizeof(header));
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      out += parts[i];
+      const std::size_t len = std::min(block_size, input.size() - i * block_size);
+      crc = crc32_combine(crc, crcs[i], static_cast<z_off_t>(len));
+    }
+
+    const std::uint32_t trailer[2] = {
+        static_cast<std::uint32_t>(crc),
+        static_cast<std::uint32_t>(input.size() & 0xffffffffu),
+    };
+    for (std::uint32_t v : trailer)
+    {
+      for (int b = 0; b < 4; ++b)
+        out.push_back(static_cast<char>((v >> (8 * b)) & 0xff));
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Decompress gzip data using zlib.
+   *
+   * @param input Gzip data.
+   * @param out Output buffer (written on success).
+   * @return true if the whole stream was inflated.
+   */
+  inline bool gzip_decompress(std::string_view input, std::string &out)
   {
     z_stream zs{};
     zs.zalloc = Z_NULL;
     zs.zfree = Z_NULL;
     zs.opaque = Z_NULL;
 
-    const int lvl = (level < 1) ? 1 : (level > 9 ? 9 : level);
-
-    if (deflateInit2(&zs, lvl, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    if (inflateInit2(&zs, 15 + 16) != Z_OK)
       return false;
 
     zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
     zs.avail_in = static_cast<uInt>(input.size());
 
     out.clear();
-    out.reserve(input.size() / 2);
+    out.reserve(input.size() * 4);
 
     char buffer[16 * 1024];
 
@@ -188,14 +746,17 @@ namespace vix::middleware::performance
       zs.next_out = reinterpret_cast<Bytef *>(buffer);
       zs.avail_out = sizeof(buffer);
 
-      ret = deflate(&zs, zs.avail_in ? Z_NO_FLUSH : Z_FINISH);
+      ret = inflate(&zs, Z_NO_FLUSH);
 
       const std::size_t written = sizeof(buffer) - zs.avail_out;
       if (written)
         out.append(buffer, written);
+
+      if (ret == Z_OK && zs.avail_in == 0 && written == 0)
+        break;
     }
 
-    deflateEnd(&zs);
+    inflateEnd(&zs);
     return (ret == Z_STREAM_END);
   }
 #endif
@@ -209,7 +770,7 @@ namespace vix::middleware::performance
    * @param quality Brotli quality (0..11).
    * @return true on success.
    */
-  inline bool brotli_compress(const std::string &input, std::string &out, int quality)
+  inline bool brotli_compress(std::string_view input, std::string &out, int quality)
   {
     const int q = (quality < 0) ? 0 : (quality > 11 ? 11 : quality);
 
@@ -236,6 +797,426 @@ namespace vix::middleware::performance
   }
 #endif
 
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+  /**
+   * @brief Per-thread zstd contexts.
+   *
+   * A ZSTD_CCtx holds its match tables and is reused across frames, so
+   * each thread allocates them once instead of on every response.
+   */
+  class ZstdContexts final
+  {
+  public:
+    ZstdContexts() = default;
+    ZstdContexts(const ZstdContexts &) = delete;
+    ZstdContexts &operator=(const ZstdContexts &) = delete;
+
+    ~ZstdContexts()
+    {
+      ZSTD_freeCCtx(cctx_);
+      ZSTD_freeDCtx(dctx_);
+    }
+
+    /** @brief Calling thread's contexts. */
+    static ZstdContexts &local()
+    {
+      thread_local ZstdContexts ctx;
+      return ctx;
+    }
+
+    /** @brief Compression context, or nullptr on allocation failure. */
+    ZSTD_CCtx *cctx()
+    {
+      if (!cctx_)
+        cctx_ = ZSTD_createCCtx();
+      return cctx_;
+    }
+
+    /** @brief Reset decompression context, or nullptr on failure. */
+    ZSTD_DCtx *dctx()
+    {
+      if (!dctx_)
+        dctx_ = ZSTD_createDCtx();
+      else if (ZSTD_isError(ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_only)))
+        return nullptr;
+      return dctx_;
+    }
+
+  private:
+    ZSTD_CCtx *cctx_{nullptr};
+    ZSTD_DCtx *dctx_{nullptr};
+  };
+
+  /**
+   * @brief Compress data with Zstandard (single frame).
+   *
+   * @param input Input data.
+   * @param out Output buffer (written on success).
+   * @param level zstd level (1..19).
+   * @return true on success.
+   */
+  inline bool zstd_compress(std::string_view input, std::string &out, int level)
+  {
+    const int lvl = (level < 1) ? 1 : (level > 19 ? 19 : level);
+
+    ZSTD_CCtx *cctx = ZstdContexts::local().cctx();
+    if (!cctx)
+      return false;
+
+    out.resize(ZSTD_compressBound(input.size()));
+
+    const std::size_t n = ZSTD_compressCCtx(
+        cctx, out.data(), out.size(), input.data(), input.size(), lvl);
+
+    if (ZSTD_isError(n))
+    {
+      out.clear();
+      return false;
+    }
+
+    out.resize(n);
+    return true;
+  }
+
+  /**
+   * @brief Compress data with Zstandard, blocks compressed in parallel.
+   *
+   * Each block becomes an independent frame; RFC 8878 decoders accept
+   * concatenated frames as one stream.
+   *
+   * @param input Input data.
+   * @param out Output buffer (written on success).
+   * @param level zstd level (1..19).
+   * @param ex Executor running the blocks (nullptr = caller only).
+   * @param block_size Uncompressed bytes per block.
+   * @return true on success.
+   */
+  inline bool zstd_compress_parallel(
+      std::string_view input,
+      std::string &out,
+      int level,
+      vix::executor::IExecutor *ex,
+      std::size_t block_size)
+  {
+    const int lvl = (level < 1) ? 1 : (level > 19 ? 19 : level);
+
+    if (block_size == 0)
+      block_size = 128 * 1024;
+
+    const std::size_t n = input.empty() ? 1 : (input.size() + block_size - 1) / block_size;
+    std::vector<std::string> parts(n);
+
+    const bool ok = run_blocks(
+        ex, n,
+        [&](std::size_t i)
+        {
+          const std::size_t begin = i * block_size;
+          const std::size_t len = std::min(block_size, input.size() - begin);
+
+          ZSTD_CCtx *cctx = ZstdContexts::local().cctx();
+          if (!cctx)
+            return false;
+
+          std::string &part = parts[i];
+          part.resize(ZSTD_compressBound(len));
+
+          const std::size_t written = ZSTD_compressCCtx(
+              cctx, part.data(), part.size(), input.data() + begin, len, lvl);
+          if (ZSTD_isError(written))
+            return false;
+
+          part.resize(written);
+          return true;
+        });
+
+    if (!ok)
+      return false;
+
+    out.clear();
+    for (const auto &part : parts)
+      out += part;
+    return true;
+  }
+
+  /**
+   * @brief Decompress Zstandard data.
+   *
+   * @param input zstd frame(s).
+   * @param out Output buffer (written on success).
+   * @return true if the input ended on a complete frame.
+   */
+  inline bool zstd_decompress(std::string_view input, std::string &out)
+  {
+    ZSTD_DCtx *dctx = ZstdContexts::local().dctx();
+    if (!dctx)
+      return false;
+
+    out.clear();
+    out.reserve(input.size() * 4);
+
+    char buffer[16 * 1024];
+    ZSTD_inBuffer in{input.data(), input.size(), 0};
+
+    std::size_t ret = 0;
+    while (in.pos < in.size)
+    {
+      ZSTD_outBuffer o{buffer, sizeof(buffer), 0};
+      ret = ZSTD_decompressStream(dctx, &o, &in);
+      if (ZSTD_isError(ret))
+        return false;
+      out.append(buffer, o.pos);
+    }
+
+    // Flush what the context still buffers for the last frame.
+    while (ret != 0)
+    {
+      ZSTD_outBuffer o{buffer, sizeof(buffer), 0};
+      ret = ZSTD_decompressStream(dctx, &o, &in);
+      if (ZSTD_isError(ret) || o.pos == 0)
+        return false;
+      out.append(buffer, o.pos);
+    }
+
+    return !input.empty();
+  }
+#endif
+
+  /**
+   * @brief Check whether a content coding is compiled in.
+   *
+   * @param encoding "zstd", "br" or "gzip".
+   */
+  inline bool encoding_available(std::string_view encoding)
+  {
+    if (encoding == "zstd")
+      return VIX_HAS_ZSTD != 0;
+    if (encoding == "br")
+      return VIX_HAS_BROTLI != 0;
+    if (encoding == "gzip")
+      return VIX_HAS_ZLIB != 0;
+    return false;
+  }
+
+  /**
+   * @brief Pick the response encoding for an Accept-Encoding header.
+   *
+   * The client's weights decide first: the available coding with the
+   * highest q wins. Ties go to the cheaper coding for the server:
+   * - "zstd" when prefer_zstd is set
+   * - "br" when prefer_br is set
+   * - "gzip"
+   * - then the non-preferred ones
+   *
+   * Nothing is picked when the client rates "identity" above every
+   * available coding.
+   *
+   * @param accept The "Accept-Encoding" header value.
+   * @param opt Compression options.
+   * @return "zstd", "br", "gzip", or an empty string when nothing acceptable is available.
+   */
+  inline std::string negotiate_encoding(
+      std::string_view accept,
+      const CompressionOptions &opt)
+  {
+    if (accept.empty())
+      return {};
+
+    const auto list = parse_accept_encoding(accept);
+    if (list.empty())
+      return {};
+
+    const std::pair<const char *, bool> order[] = {
+        {"zstd", opt.prefer_zstd},
+        {"br", opt.prefer_br},
+        {"gzip", true},
+        {"br", !opt.prefer_br},
+        {"zstd", !opt.prefer_zstd},
+    };
+
+    const char *best = nullptr;
+    double best_q = 0.0;
+
+    for (const auto &[coding, preferred] : order)
+    {
+      if (!preferred || !encoding_available(coding))
+        continue;
+
+      const double q = accepted_q(list, coding);
+      if (q > best_q)
+      {
+        best = coding;
+        best_q = q;
+      }
+    }
+
+    if (!best)
+      return {};
+
+    for (const auto &ac : list)
+    {
+      if (ac.coding == "identity" && ac.q > best_q)
+        return {};
+    }
+
+    return best;
+  }
+
+  /**
+   * @brief Compress data with a named content coding at a given level.
+   *
+   * Large inputs are compressed in parallel when opt.executor is set
+   * (gzip and zstd; Brotli always runs on the caller).
+   *
+   * @param encoding "zstd", "br" or "gzip".
+   * @param input Input data.
+   * @param out Output buffer (written on success).
+   * @param level Codec level (gzip 1..9, br 0..11, zstd 1..19).
+   * @param opt Compression options (parallel mode).
+   * @return true on success, false if the coding is unknown or unavailable.
+   */
+  inline bool compress_with_level(
+      [[maybe_unused]] std::string_view encoding,
+      [[maybe_unused]] std::string_view input,
+      [[maybe_unused]] std::string &out,
+      [[maybe_unused]] int level,
+      [[maybe_unused]] const CompressionOptions &opt)
+  {
+    [[maybe_unused]] const bool parallel =
+        opt.executor && input.size() >= opt.parallel_min_size;
+
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+    if (encoding == "zstd")
+      return parallel
+                 ? zstd_compress_parallel(input, out, level, opt.executor, opt.parallel_block_size)
+                 : zstd_compress(input, out, level);
+#endif
+
+#if defined(VIX_HAS_BROTLI) && VIX_HAS_BROTLI
+    if (encoding == "br")
+      return brotli_compress(input, out, level);
+#endif
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+    if (encoding == "gzip")
+      return parallel
+                 ? gzip_compress_parallel(input, out, level, opt.executor, opt.parallel_block_size)
+                 : gzip_compress(input, out, level);
+#endif
+
+    return false;
+  }
+
+  /**
+   * @brief Level used for a content coding.
+   *
+   * @param encoding "zstd", "br" or "gzip".
+   * @param opt Compression options.
+   * @return The adaptive level when opt.adaptive is set, else the
+   * configured one (gzip_level, brotli_quality, zstd_level).
+   */
+  inline int compression_level(std::string_view encoding, const CompressionOptions &opt)
+  {
+    const int configured = (encoding == "br")     ? opt.brotli_quality
+                           : (encoding == "zstd") ? opt.zstd_level
+                                                  : opt.gzip_level;
+
+    return opt.adaptive ? opt.adaptive->level(encoding, configured) : configured;
+  }
+
+  /**
+   * @brief Compress data with a named content coding.
+   *
+   * Uses the configured level (gzip_level, brotli_quality, zstd_level),
+   * or the adaptive one when opt.adaptive is set; the codec time is then
+   * reported back to the controller. With opt.memo, a body compressed
+   * before at the same level is served from the memo.
+   *
+   * @param encoding "zstd", "br" or "gzip".
+   * @param input Input data.
+   * @param out Output buffer (written on success).
+   * @param opt Compression options (levels, parallel mode, adaptive controller, memo).
+   * @return true on success, false if the coding is unknown or unavailable.
+   */
+  inline bool compress_with(
+      std::string_view encoding,
+      std::string_view input,
+      std::string &out,
+      const CompressionOptions &opt)
+  {
+    const int level = compression_level(encoding, opt);
+
+    if (opt.memo)
+    {
+      if (auto hit = opt.memo->get(encoding, level, input))
+      {
+        out = *hit;
+        return true;
+      }
+    }
+
+    bool ok = false;
+    if (!opt.adaptive)
+    {
+      ok = compress_with_level(encoding, input, out, level, opt);
+    }
+    else
+    {
+      const auto t0 = std::chrono::steady_clock::now();
+      ok = compress_with_level(encoding, input, out, level, opt);
+      if (ok)
+      {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0);
+        opt.adaptive->record(encoding, input.size(), ns.count());
+      }
+    }
+
+    if (ok && opt.memo)
+      opt.memo->put(encoding, level, input, out);
+
+    return ok;
+  }
+
+  /**
+   * @brief Decompress data encoded with a named content coding.
+   *
+   * @param encoding "gzip" or "zstd".
+   * @param input Encoded data.
+   * @param out Output buffer (written on success).
+   * @return true on success, false if the coding is unsupported or the data is corrupt.
+   */
+  inline bool decompress_with(
+      [[maybe_unused]] std::string_view encoding,
+      [[maybe_unused]] std::string_view input,
+      [[maybe_unused]] std::string &out)
+  {
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+    if (encoding == "gzip")
+      return gzip_decompress(input, out);
+#endif
+
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+    if (encoding == "zstd")
+      return zstd_decompress(input, out);
+#endif
+
+    return false;
+  }
+
+  /**
+   * @brief Append "Vary: Accept-Encoding" unless it is already present.
+   *
+   * @param res Response wrapper.
+   */
+  inline void add_vary_accept_encoding(vix::middleware::Response &res)
+  {
+    const std::string vary = res.res.header("Vary");
+    if (contains_token_icase(vary, "accept-encoding"))
+      return;
+
+    res.append("Vary", "Accept-Encoding");
+  }
+
   /**
    * @brief Check if the response already has a Content-Encoding.
    *
@@ -248,6 +1229,22 @@ namespace vix::middleware::performance
     return !raw.header("Content-Encoding").empty();
   }
 
+  /**
+   * @brief Check if the response is a byte range of the representation.
+   *
+   * A 206 body (or any body described by Content-Range) is a slice whose
+   * offsets refer to the identity representation; encoding it would
+   * corrupt range reassembly.
+   *
+   * @param res Response wrapper.
+   * @return true for 206 responses and responses with Content-Range.
+   */
+  inline bool is_partial_response(vix::middleware::Response &res)
+  {
+    auto &raw = res.res;
+    return raw.status() == 206 || !raw.header("Content-Range").empty();
+  }
+
   /**
    * @brief Decide if an HTTP status code is eligible for compression.
    *
@@ -261,6 +1258,123 @@ namespace vix::middleware::performance
     return (code >= 200 && code < 300);
   }
 
+  /**
+   * @brief Match a media type against a compress_types/skip_types entry.
+   *
+   * @param type Lower-case media type without parameters.
+   * @param pattern "top/" prefix, "+suffix", or an exact type.
+   */
+  inline bool media_type_matches(std::string_view type, std::string_view pattern)
+  {
+    if (pattern.empty() || type.size() < pattern.size())
+      return false;
+
+    if (pattern.back() == '/')
+      return type.compare(0, pattern.size(), pattern) == 0;
+
+    if (pattern.front() == '+')
+      return type.compare(type.size() - pattern.size(), pattern.size(), pattern) == 0;
+
+    return type == pattern;
+  }
+
+  /**
+   * @brief Check a Content-Type against the compression type policy.
+   *
+   * @param content_type Raw Content-Type header (parameters ignored).
+   * @param opt Compression options.
+   * @return true if the type may be compressed.
+   */
+  inline bool is_compressible_type(std::string_view content_type, const CompressionOptions &opt)
+  {
+    content_type = content_type.substr(0, content_type.find(';'));
+    while (!content_type.empty() && content_type.back() == ' ')
+      content_type.remove_suffix(1);
+    while (!content_type.empty() && content_type.front() == ' ')
+      content_type.remove_prefix(1);
+
+    if (content_type.empty())
+      return opt.compress_untyped;
+
+    std::string type(content_type);
+    for (auto &c : type)
+      c = (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+
+    for (const auto &p : opt.skip_types)
+    {
+      if (media_type_matches(type, p))
+        return false;
+    }
+
+    if (opt.compress_types.empty())
+      return true;
+
+    for (const auto &p : opt.compress_types)
+    {
+      if (media_type_matches(type, p))
+        return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Estimate how much a body would shrink from its byte entropy.
+   *
+   * Computes the order-0 Shannon entropy of the first @p sample_bytes
+   * bytes. It ignores repetition, so it underestimates the gain on text
+   * but reliably flags random or already-compressed data (close to 8
+   * bits per byte).
+   *
+   * @param body Body to sample.
+   * @param sample_bytes Bytes to look at.
+   * @return Estimated size reduction in [0, 1].
+   */
+  inline double estimate_compression_gain(std::string_view body, std::size_t sample_bytes)
+  {
+    const std::size_t n = body.size() < sample_bytes ? body.size() : sample_bytes;
+    if (n == 0)
+      return 0.0;
+
+    std::size_t counts[256] = {};
+    for (std::size_t i = 0; i < n; ++i)
+      ++counts[static_cast<unsigned char>(body[i])];
+
+    double bits = 0.0;
+    for (std::size_t c : counts)
+    {
+      if (c == 0)
+        continue;
+      const double p = static_cast<double>(c) / static_cast<double>(n);
+      bits -= p * std::log2(p);
+    }
+
+    return 1.0 - bits / 8.0;
+  }
+
+  /**
+   * @brief Decide whether a body should be compressed at all.
+   *
+   * Applies the type policy, then the optional entropy sample.
+   *
+   * @param content_type Raw Content-Type header.
+   * @param body Response body.
+   * @param opt Compression options.
+   * @return true if compression is expected to pay off.
+   */
+  inline bool worth_compressing(
+      std::string_view content_type,
+      std::string_view body,
+      const CompressionOptions &opt)
+  {
+    if (!is_compressible_type(content_type, opt))
+      return false;
+
+    if (opt.sample_bytes == 0)
+      return true;
+
+    return estimate_compression_gain(body, opt.sample_bytes) >= opt.min_gain;
+  }
+
   /**
    * @brief Replace response body and update content-length.
    *
@@ -269,31 +1383,34 @@ namespace vix::middleware::performance
    */
   inline void set_body_and_length(vix::middleware::Response &res, std::string &&body)
   {
-    auto &raw = res.res;
-    raw.set_body(std::move(body));
+    vix::middleware::utils::replace_body(res.res, std::move(body));
   }
 
   /**
    * @brief Response compression middleware.
    *
    * Reads Accept-Encoding and, after downstream handlers run, attempts to
-   * compress the response body using:
-   * - Brotli ("br") when available and preferred/accepted
-   * - gzip ("gzip") when available and accepted
+   * compress the response body with the coding picked by
+   * negotiate_encoding(): the client's highest-weighted coding among
+   * zstd, br and gzip (those compiled in), ties broken by server cost.
    *
    * Compression is skipped if:
    * - middleware is disabled
    * - status is not compressible (currently non-2xx)
    * - response already has Content-Encoding set
+   * - response is a byte range (206 or Content-Range)
+   * - the body is streamed (performance::BodyStream encodes it itself)
    * - body size is smaller than min_size
+   * - Content-Type is excluded by compress_types/skip_types, or the
+   *   optional entropy sample predicts less than min_gain
    * - no acceptable algorithm is available
    *
    * Headers:
    * - Optionally appends "Vary: Accept-Encoding"
-   * - Sets "Content-Encoding" to "br" or "gzip" when applied
+   * - Sets "Content-Encoding" to "zstd", "br" or "gzip" when applied
    * - In debug builds, sets:
    *   - X-Vix-Compression: planned/applied
-   *   - X-Vix-Compression-Choice: none/gzip/br
+   *   - X-Vix-Compression-Choice: none/skipped/gzip/br/zstd
    *
    * @param opt Compression options.
    * @return A middleware function (MiddlewareFn).
@@ -308,26 +1425,27 @@ namespace vix::middleware::performance
         return;
       }
 
-      const std::string ae = ctx.req().header("accept-encoding");
-
-      const bool wants_br = token_allowed(ae, "br");
-      const bool wants_gzip = token_allowed(ae, "gzip");
+      const std::string encoding =
+          negotiate_encoding(ctx.req().header("accept-encoding"), opt);
 
       next();
 
+      if (vix::middleware::utils::body_streamed(ctx.req()))
+        return;
+
       auto &res = ctx.res();
       auto &raw = res.res;
 
       if (opt.add_vary)
-        res.append("Vary", "Accept-Encoding");
+        add_vary_accept_encoding(res);
 
       if (!is_compressible_status(raw.status()))
         return;
 
-      if (response_already_encoded(res))
+      if (response_already_encoded(res) || is_partial_response(res))
         return;
 
-      const std::string body = raw.body();
+      const std::string_view body = vix::middleware::utils::body_view(raw);
       if (body.size() < opt.min_size)
         return;
 
@@ -335,64 +1453,25 @@ namespace vix::middleware::performance
       res.header("X-Vix-Compression", "planned");
 #endif
 
-      enum class Algo
-      {
-        None,
-        Br,
-        Gzip
-      };
-
-      Algo algo = Algo::None;
-
-#if defined(VIX_HAS_BROTLI) && VIX_HAS_BROTLI
-      if (opt.prefer_br && wants_br)
-        algo = Algo::Br;
-#endif
-
-#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
-      if (algo == Algo::None && wants_gzip)
-        algo = Algo::Gzip;
-#endif
-
-#if defined(VIX_HAS_BROTLI) && VIX_HAS_BROTLI
-      if (algo == Algo::None && wants_br)
-        algo = Algo::Br;
-#endif
-
-      if (algo == Algo::None)
+      if (encoding.empty())
       {
         res.header("X-Vix-Compression-Choice", "none");
         return;
       }
 
-      std::string compressed;
-
-      if (algo == Algo::Gzip)
+      if (!worth_compressing(raw.header("Content-Type"), body, opt))
       {
-#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
-        if (!gzip_compress(body, compressed, opt.gzip_level))
-          return;
-
-        res.header("Content-Encoding", "gzip");
-        res.header("X-Vix-Compression-Choice", "gzip");
-        set_body_and_length(res, std::move(compressed));
-#else
+        res.header("X-Vix-Compression-Choice", "skipped");
         return;
-#endif
       }
-      else if (algo == Algo::Br)
-      {
-#if defined(VIX_HAS_BROTLI) && VIX_HAS_BROTLI
-        if (!brotli_compress(body, compressed, opt.brotli_quality))
-          return;
 
-        res.header("Content-Encoding", "br");
-        res.header("X-Vix-Compression-Choice", "br");
-        set_body_and_length(res, std::move(compressed));
-#else
+      std::string compressed;
+      if (!compress_with(encoding, body, compressed, opt))
         return;
-#endif
-      }
+
+      res.header("Content-Encoding", encoding);
+      res.header("X-Vix-Compression-Choice", encoding);
+      set_body_and_length(res, std::move(compressed));
 
 #ifndef NDEBUG
       res.header("X-Vix-Compression", "applied");
@@ -0,0 +1,425 @@
+/**
+ *
+ *  @file compression_dictionary.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_COMPRESSION_DICTIONARY_HPP
+#define VIX_COMPRESSION_DICTIONARY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <openssl/evp.h>
+
+#include <vix/middleware/middleware.hpp>
+#include <vix/middleware/performance/compression.hpp>
+#include <vix/middleware/performance/static_files.hpp>
+
+/**
+ * Dictionary compression uses zstd ("dcz" content coding, RFC 9842
+ * Compression Dictionary Transport) and needs -DVIX_HAS_ZSTD=1.
+ */
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+#include <zdict.h>
+#endif
+
+namespace vix::middleware::performance
+{
+  /**
+   * @brief Options for a CompressionDictionary and dictionary_compression().
+   */
+  struct DictionaryOptions
+  {
+    /**
+     * @brief URL the dictionary itself is served from.
+     */
+    std::string path{"/_vix/dictionary/api.dict"};
+
+    /**
+     * @brief Responses the dictionary applies to: a path prefix followed
+     * by '*', or an exact path.
+     *
+     * Sent to clients in Use-As-Dictionary.
+     */
+    std::string match{"/api/*"};
+
+    /**
+     * @brief zstd level used with the dictionary.
+     */
+    int level{3};
+
+    /**
+     * @brief Minimum body size before dictionary compression is attempted.
+     *
+     * Much lower than CompressionOptions::min_size: small bodies are where
+     * a dictionary pays off.
+     */
+    std::size_t min_size{64};
+
+    /**
+     * @brief Cache-Control sent with the dictionary.
+     */
+    std::string cache_control{"public, max-age=86400"};
+
+    /**
+     * @brief Advertise the dictionary with a Link header on matching
+     * responses sent to clients that do not have it yet.
+     */
+    bool advertise{true};
+  };
+
+  /**
+   * @brief Standard base64 (with padding) of a byte buffer.
+   */
+  inline std::string base64_encode(std::string_view in)
+  {
+    static constexpr char tbl[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    out.reserve(((in.size() + 2) / 3) * 4);
+
+    std::size_t i = 0;
+    for (; i + 2 < in.size(); i += 3)
+    {
+      const unsigned v = (static_cast<unsigned char>(in[i]) << 16) |
+                         (static_cast<unsigned char>(in[i + 1]) << 8) |
+                         static_cast<unsigned char>(in[i + 2]);
+      out.push_back(tbl[(v >> 18) & 63]);
+      out.push_back(tbl[(v >> 12) & 63]);
+      out.push_back(tbl[(v >> 6) & 63]);
+      out.push_back(tbl[v & 63]);
+    }
+
+    if (i < in.size())
+    {
+      unsigned v = static_cast<unsigned char>(in[i]) << 16;
+      if (i + 1 < in.size())
+        v |= static_cast<unsigned char>(in[i + 1]) << 8;
+
+      out.push_back(tbl[(v >> 18) & 63]);
+      out.push_back(tbl[(v >> 12) & 63]);
+      out.push_back(i + 1 < in.size() ? tbl[(v >> 6) & 63] : '=');
+      out.push_back('=');
+    }
+
+    return out;
+  }
+
+  /**
+   * @brief Raw SHA-256 digest (32 bytes), or an empty string on failure.
+   */
+  inline std::string sha256_raw(std::string_view data)
+  {
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+
+    if (EVP_Digest(data.data(), data.size(), md, &len, EVP_sha256(), nullptr) != 1)
+      return {};
+
+    return std::string(reinterpret_cast<const char *>(md), len);
+  }
+
+  /**
+   * @brief Check a path against a Use-As-Dictionary match pattern.
+   *
+   * @param path Request path.
+   * @param pattern Exact path, or prefix followed by '*'.
+   */
+  inline bool dictionary_matches(std::string_view path, std::string_view pattern)
+  {
+    if (!pattern.empty() && pattern.back() == '*')
+      return starts_with(path, pattern.substr(0, pattern.size() - 1));
+    return path == pattern;
+  }
+
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+  /**
+   * @brief Train a zstd dictionary from sample response bodies.
+   *
+   * Give it a few hundred representative bodies (zstd recommends about
+   * 100x the dictionary size of samples in total).
+   *
+   * @param samples Sample bodies.
+   * @param out Dictionary bytes (written on success).
+   * @param max_size Dictionary capacity in bytes.
+   * @return false if there are too few samples or training failed.
+   */
+  inline bool train_dictionary(
+      const std::vector<std::string> &samples,
+      std::string &out,
+      std::size_t max_size = 16 * 1024)
+  {
+    std::string joined;
+    std::vector<std::size_t> sizes;
+    sizes.reserve(samples.size());
+
+    for (const auto &s : samples)
+    {
+      if (s.empty())
+        continue;
+      joined += s;
+      sizes.push_back(s.size());
+    }
+
+    if (sizes.size() < 8 || max_size == 0)
+      return false;
+
+    out.resize(max_size);
+    const std::size_t n = ZDICT_trainFromBuffer(
+        out.data(), out.size(),
+        joined.data(), sizes.data(), static_cast<unsigned>(sizes.size()));
+
+    if (ZDICT_isError(n))
+    {
+      out.clear();
+      return false;
+    }
+
+    out.resize(n);
+    return true;
+  }
+
+  /**
+   * @brief A loaded zstd dictionary used for the "dcz" content coding.
+   *
+   * The dictionary is digested once (ZSTD_CDict / ZSTD_DDict) and shared by
+   * every thread; compression uses the calling thread's ZSTD_CCtx.
+   *
+   * "dcz" output is a zstd skippable frame carrying the SHA-256 of the
+   * dictionary, followed by a zstd frame compressed with it.
+   */
+  class CompressionDictionary final
+  {
+  public:
+    CompressionDictionary(const CompressionDictionary &) = delete;
+    CompressionDictionary &operator=(const CompressionDictionary &) = delete;
+
+    ~CompressionDictionary()
+    {
+      ZSTD_freeCDict(cdict_);
+      ZSTD_freeDDict(ddict_);
+    }
+
+    /**
+     * @brief Load a dictionary from memory.
+     *
+     * @return The dictionary, or nullptr if it cannot be digested.
+     */
+    static std::shared_ptr<CompressionDictionary> load(std::string bytes, DictionaryOptions opt = {})
+    {
+      if (bytes.empty())
+        return nullptr;
+
+      std::shared_ptr<CompressionDictionary> d(new CompressionDictionary(std::move(bytes), std::move(opt)));
+      if (!d->cdict_ || !d->ddict_ || d->hash_.size() != 32)
+        return nullptr;
+      return d;
+    }
+
+    /**
+     * @brief Load a dictionary file (e.g. written from train_dictionary()).
+     *
+     * @return The dictionary, or nullptr if unreadable or invalid.
+     */
+    static std::shared_ptr<CompressionDictionary> load_file(const std::filesystem::path &p, DictionaryOptions opt = {})
+    {
+      std::string bytes;
+      if (!read_file_to_string(p, bytes))
+        return nullptr;
+      return load(std::move(bytes), std::move(opt));
+    }
+
+    /**
+     * @brief Compress into the "dcz" format.
+     */
+    bool compress(std::string_view input, std::string &out) const
+    {
+      ZSTD_CCtx *cctx = ZstdContexts::local().cctx();
+      if (!cctx)
+        return false;
+
+      static constexpr char magic[8] = {'\x5e', '\x2a', '\x4d', '\x18', '\x20', 0, 0, 0};
+
+      out.resize(sizeof(magic) + hash_.size() + ZSTD_compressBound(input.size()));
+      std::copy(magic, magic + sizeof(magic), out.data());
+      std::copy(hash_.begin(), hash_.end(), out.data() + sizeof(magic));
+
+      const std::size_t head = sizeof(magic) + hash_.size();
+      const std::size_t n = ZSTD_compress_usingCDict(
+          cctx, out.data() + head, out.size() - head, input.data(), input.size(), cdict_);
+
+      if (ZSTD_isError(n))
+      {
+        out.clear();
+        return false;
+      }
+
+      out.resize(head + n);
+      return true;
+    }
+
+    /**
+     * @brief Decode a "dcz" body produced with this dictionary.
+     */
+    bool decompress(std::string_view input, std::string &out) const
+    {
+      constexpr std::size_t head = 8 + 32;
+      if (input.size() < head || input.compare(8, 32, hash_) != 0)
+        return false;
+
+      ZSTD_DCtx *dctx = ZstdContexts::local().dctx();
+      if (!dctx)
+        return false;
+
+      const unsigned long long size = ZSTD_getFrameContentSize(input.data() + head, input.size() - head);
+      if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN)
+        return false;
+
+      out.resize(static_cast<std::size_t>(size));
+      const std::size_t n = ZSTD_decompress_usingDDict(
+          dctx, out.data(), out.size(), input.data() + head, input.size() - head, ddict_);
+
+      if (ZSTD_isError(n) || n != out.size())
+      {
+        out.clear();
+        return false;
+      }
+      return true;
+    }
+
+    /**
+     * @brief Dictionary id as clients send it in Available-Dictionary
+     * (structured-field byte sequence of the SHA-256).
+     */
+    const std::string &id() const noexcept { return id_; }
+
+    /** @brief Dictionary bytes. */
+    const std::string &bytes() const noexcept { return bytes_; }
+
+    const DictionaryOptions &options() const noexcept { return opt_; }
+
+  private:
+    CompressionDictionary(std::string bytes, DictionaryOptions opt)
+        : bytes_(std::move(bytes)),
+          opt_(std::move(opt)),
+          hash_(sha256_raw(bytes_)),
+          id_(":" + base64_encode(hash_) + ":"),
+          cdict_(ZSTD_createCDict(bytes_.data(), bytes_.size(), opt_.level)),
+          ddict_(ZSTD_createDDict(bytes_.data(), bytes_.size()))
+    {
+    }
+
+  private:
+    std::string bytes_;
+    DictionaryOptions opt_;
+    std::string hash_;
+    std::string id_;
+    ZSTD_CDict *cdict_{nullptr};
+    ZSTD_DDict *ddict_{nullptr};
+  };
+
+  /**
+   * @brief Dictionary compression middleware (RFC 9842, "dcz").
+   *
+   * - GET on options().path serves the dictionary with Use-As-Dictionary
+   * - matching responses are compressed with the dictionary when the
+   *   client accepts "dcz" and sends our id in Available-Dictionary;
+   *   they get Content-Encoding: dcz and
+   *   Vary: Accept-Encoding, Available-Dictionary
+   * - other matching responses get a Link rel="compression-dictionary"
+   *   header (when advertise is set) so browsers fetch the dictionary
+   *
+   * Bodies go through the same checks as compression() (2xx, not already
+   * encoded, Content-Type policy of @p copt). Install it after
+   * compression() so it sees the response first; responses it leaves
+   * alone fall back to regular compression.
+   *
+   * @param dict Loaded dictionary (nullptr disables the middleware).
+   * @param copt Content-Type policy.
+   * @return A middleware function (MiddlewareFn).
+   */
+  inline MiddlewareFn dictionary_compression(
+      std::shared_ptr<const CompressionDictionary> dict,
+      CompressionOptions copt = {})
+  {
+    return [dict = std::move(dict), copt = std::move(copt)](Context &ctx, Next next) mutable
+    {
+      if (!dict)
+      {
+        next();
+        return;
+      }
+
+      const DictionaryOptions &opt = dict->options();
+      const std::string path = ctx.req().path();
+
+      if (path == opt.path && (ctx.req().method() == "GET" || ctx.req().method() == "HEAD"))
+      {
+        auto &res = ctx.res();
+        res.header("Content-Type", "application/octet-stream");
+        res.header("Use-As-Dictionary", "match=\"" + opt.match + "\"");
+        res.header("Cache-Control", opt.cache_control);
+        res.status(200);
+        res.res.set_body(ctx.req().method() == "HEAD" ? std::string{} : dict->bytes());
+        return;
+      }
+
+      if (!dictionary_matches(path, opt.match))
+      {
+        next();
+        return;
+      }
+
+      const bool has_dict = ctx.req().header("available-dictionary") == dict->id() &&
+                            token_allowed(ctx.req().header("accept-encoding"), "dcz");
+
+      next();
+
+      auto &res = ctx.res();
+      auto &raw = res.res;
+
+      add_vary_accept_encoding(res);
+      if (!contains_token_icase(raw.header("Vary"), "available-dictionary"))
+        res.append("Vary", "Available-Dictionary");
+
+      if (!has_dict)
+      {
+        if (opt.advertise)
+          res.header("Link", "<" + opt.path + ">; rel=\"compression-dictionary\"");
+        return;
+      }
+
+      if (!is_compressible_status(raw.status()) || response_already_encoded(res) || is_partial_response(res))
+        return;
+
+      const std::string_view body = vix::middleware::utils::body_view(raw);
+      if (body.size() < opt.min_size || !worth_compressing(raw.header("Content-Type"), body, copt))
+        return;
+
+      std::string packed;
+      if (!dict->compress(body, packed) || packed.size() >= body.size())
+        return;
+
+      res.header("Content-Encoding", "dcz");
+      set_body_and_length(res, std::move(packed));
+    };
+  }
+#endif
+
+} // namespace vix::middleware::performance
+
+#endif // VIX_COMPRESSION_DICTIONARY_HPP
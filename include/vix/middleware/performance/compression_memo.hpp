@@ -0,0 +1,222 @@
+/**
+ *
+ *  @file compression_memo.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_COMPRESSION_MEMO_HPP
+#define VIX_COMPRESSION_MEMO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace vix::middleware::performance
+{
+  /**
+   * @brief Options for CompressionMemo.
+   */
+  struct CompressionMemoOptions
+  {
+    /**
+     * @brief Byte budget of the memoized compressed outputs.
+     */
+    std::size_t max_bytes{4 * 1024 * 1024};
+
+    /**
+     * @brief Larger inputs are not memoized.
+     */
+    std::size_t max_entry_bytes{256 * 1024};
+  };
+
+  /**
+   * @brief Counters exposed by CompressionMemo.
+   */
+  struct CompressionMemoStats
+  {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t evictions{0};
+    std::size_t entries{0};
+    std::size_t bytes{0};
+  };
+
+  /**
+   * @brief Bounded memo of compressed outputs keyed by input hash.
+   *
+   * Handlers often return byte-identical bodies (config payloads, feature
+   * lists) that are not worth a response cache. The memo maps
+   * (hash of the body, body length, encoding, level) to the compressed
+   * bytes, so repeated bodies skip the codec. Entries are evicted least
+   * recently used first to stay within max_bytes.
+   *
+   * Thread-safe. The body is hashed outside the lock; outputs are shared
+   * immutable strings, copied out after the lock is released.
+   */
+  class CompressionMemo final
+  {
+  public:
+    using Output = std::shared_ptr<const std::string>;
+
+    explicit CompressionMemo(CompressionMemoOptions opt = {})
+        : opt_(opt)
+    {
+    }
+
+    CompressionMemo(const CompressionMemo &) = delete;
+    CompressionMemo &operator=(const CompressionMemo &) = delete;
+
+    /**
+     * @brief Look up the compressed form of @p input.
+     *
+     * @return The output, or nullptr on miss.
+     */
+    Output get(std::string_view encoding, int level, std::string_view input)
+    {
+      if (input.size() > opt_.max_entry_bytes)
+        return nullptr;
+
+      const Key k = key_(encoding, level, input);
+
+      std::lock_guard<std::mutex> lock(mu_);
+      auto it = index_.find(k);
+      if (it == index_.end())
+      {
+        ++misses_;
+        return nullptr;
+      }
+
+      lru_.splice(lru_.begin(), lru_, it->second);
+      ++hits_;
+      return it->second->output;
+    }
+
+    /**
+     * @brief Remember the compressed form of @p input.
+     */
+    void put(std::string_view encoding, int level, std::string_view input, std::string output)
+    {
+      if (input.size() > opt_.max_entry_bytes || output.size() > opt_.max_bytes)
+        return;
+
+      const Key k = key_(encoding, level, input);
+      auto shared = std::make_shared<const std::string>(std::move(output));
+      const std::size_t bytes = shared->size() + sizeof(Node);
+
+      std::list<Node> dropped; // released after the lock
+      std::lock_guard<std::mutex> lock(mu_);
+
+      auto it = index_.find(k);
+      if (it != index_.end())
+      {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+      }
+
+      while (!lru_.empty() && bytes_ + bytes > opt_.max_bytes)
+      {
+        auto last = std::prev(lru_.end());
+        bytes_ -= last->bytes;
+        index_.erase(last->key);
+        dropped.splice(dropped.begin(), lru_, last);
+        ++evictions_;
+      }
+
+      lru_.push_front(Node{k, std::move(shared), bytes});
+      index_.emplace(k, lru_.begin());
+      bytes_ += bytes;
+    }
+
+    /** @brief Drop everything. */
+    void clear()
+    {
+      std::list<Node> dropped;
+      std::lock_guard<std::mutex> lock(mu_);
+      index_.clear();
+      dropped.swap(lru_);
+      bytes_ = 0;
+    }
+
+    /** @brief Snapshot of counters. */
+    CompressionMemoStats stats() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+
+      CompressionMemoStats st;
+      st.hits = hits_;
+      st.misses = misses_;
+      st.evictions = evictions_;
+      st.entries = index_.size();
+      st.bytes = bytes_;
+      return st;
+    }
+
+    const CompressionMemoOptions &options() const noexcept { return opt_; }
+
+  private:
+    struct Key
+    {
+      std::uint64_t hash{0};
+      std::size_t size{0};
+      int level{0};
+      std::string encoding{};
+
+      bool operator==(const Key &o) const noexcept
+      {
+        return hash == o.hash && size == o.size && level == o.level && encoding == o.encoding;
+      }
+    };
+
+    struct KeyHash
+    {
+      std::size_t operator()(const Key &k) const noexcept
+      {
+        return static_cast<std::size_t>(k.hash ^ (k.size * 0x9e3779b97f4a7c15ull) ^
+                                         static_cast<std::uint64_t>(k.level));
+      }
+    };
+
+    struct Node
+    {
+      Key key;
+      Output output;
+      std::size_t bytes{0};
+    };
+
+    static Key key_(std::string_view encoding, int level, std::string_view input)
+    {
+      return Key{
+          static_cast<std::uint64_t>(std::hash<std::string_view>{}(input)),
+          input.size(),
+          level,
+          std::string(encoding)};
+    }
+
+  private:
+    CompressionMemoOptions opt_{};
+    mutable std::mutex mu_;
+    std::list<Node> lru_;
+    std::unordered_map<Key, std::list<Node>::iterator, KeyHash> index_;
+    std::size_t bytes_{0};
+    std::uint64_t hits_{0};
+    std::uint64_t misses_{0};
+    std::uint64_t evictions_{0};
+  };
+
+} // namespace vix::middleware::performance
+
+#endif // VIX_COMPRESSION_MEMO_HPP
@@ -18,6 +18,7 @@
 #include <string_view>
 
 #include <vix/middleware/middleware.hpp>
+#include <vix/middleware/utils/body.hpp>
 
 namespace vix::middleware::performance
 {
@@ -32,9 +33,17 @@ namespace vix::middleware::performance
     std::size_t min_body_size{1};
   };
 
-  inline std::uint64_t fnv1a_64(std::string_view s)
+  /** @brief FNV-1a 64-bit offset basis. */
+  inline constexpr std::uint64_t fnv1a_64_basis = 1469598103934665603ull;
+
+  /**
+   * @brief Continue an FNV-1a hash over @p s.
+   *
+   * fnv1a_64_update(fnv1a_64_update(fnv1a_64_basis, a), b) equals
+   * fnv1a_64(a + b), so bodies can be hashed chunk by chunk.
+   */
+  inline std::uint64_t fnv1a_64_update(std::uint64_t h, std::string_view s)
   {
-    std::uint64_t h = 1469598103934665603ull;
     for (unsigned char c : s)
     {
       h ^= static_cast<std::uint64_t>(c);
@@ -43,6 +52,11 @@ namespace vix::middleware::performance
     return h;
   }
 
+  inline std::uint64_t fnv1a_64(std::string_view s)
+  {
+    return fnv1a_64_update(fnv1a_64_basis, s);
+  }
+
   inline std::string to_hex_u64(std::uint64_t v)
   {
     static const char *hex = "0123456789abcdef";
@@ -73,12 +87,15 @@ namespace vix::middleware::performance
 
       next();
 
+      if (vix::middleware::utils::body_streamed(ctx.req()))
+        return;
+
       auto &res = ctx.res();
       const int sc = res.res.status();
       if (sc < 200 || sc >= 300)
         return;
 
-      const std::string body = res.res.body();
+      const std::string_view body = vix::middleware::utils::body_view(res.res);
       if (body.size() < opt.min_body_size)
         return;
 
@@ -13,14 +13,21 @@
 #ifndef VIX_STATIC_FILES_HPP
 #define VIX_STATIC_FILES_HPP
 
+#include <cstddef>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include <vix/executor/IExecutor.hpp>
 #include <vix/middleware/middleware.hpp>
+#include <vix/middleware/performance/compression.hpp>
 
 namespace vix::middleware::performance
 {
@@ -57,6 +64,32 @@ namespace vix::middleware::performance
      * If false, missing files will produce a 404 response directly.
      */
     bool fallthrough{true};
+
+    /**
+     * @brief Serve precompressed sidecars (app.js.br, app.js.zst, app.js.gz)
+     * when the client accepts their coding.
+     *
+     * A sidecar older than its source file is ignored.
+     */
+    bool precompressed{true};
+
+    /**
+     * @brief Sidecar codings looked up, in server preference order (breaks
+     * Accept-Encoding q-value ties).
+     */
+    std::vector<std::string> precompressed_encodings{"br", "zstd", "gzip"};
+  };
+
+  /**
+   * @brief Counters returned by generate_sidecars().
+   */
+  struct SidecarReport
+  {
+    std::size_t scanned{0}; ///< source files considered
+    std::size_t written{0}; ///< sidecars created or refreshed
+    std::size_t fresh{0};   ///< sidecars already up to date
+    std::size_t skipped{0}; ///< too small, not compressible, or no gain
+    std::size_t failed{0};  ///< codec or I/O errors
   };
 
   /**
@@ -143,6 +176,271 @@ namespace vix::middleware::performance
     return true;
   }
 
+  /**
+   * @brief File extension of the sidecar for a content coding.
+   *
+   * @param encoding "br", "zstd" or "gzip".
+   * @return ".br", ".zst", ".gz", or an empty string for unknown codings.
+   */
+  inline std::string_view sidecar_extension(std::string_view encoding)
+  {
+    if (encoding == "br")
+      return ".br";
+    if (encoding == "zstd")
+      return ".zst";
+    if (encoding == "gzip")
+      return ".gz";
+    return {};
+  }
+
+  /**
+   * @brief A precompressed variant of a static file.
+   */
+  struct Sidecar
+  {
+    std::string encoding;
+    std::filesystem::path path;
+  };
+
+  /**
+   * @brief Check that @p side exists and is not older than @p source.
+   */
+  inline bool sidecar_fresh(const std::filesystem::path &source, const std::filesystem::path &side)
+  {
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(side, ec))
+      return false;
+
+    const auto side_time = std::filesystem::last_write_time(side, ec);
+    if (ec)
+      return false;
+
+    const auto source_time = std::filesystem::last_write_time(source, ec);
+    return !ec && side_time >= source_time;
+  }
+
+  /**
+   * @brief Pick the sidecar to serve for a file.
+   *
+   * Same rules as negotiate_encoding(): the client's highest-weighted
+   * coding among the sidecars on disk, ties broken by
+   * precompressed_encodings order, nothing if "identity" ranks higher.
+   *
+   * @param full Source file path.
+   * @param accept The "Accept-Encoding" header value.
+   * @param opt Static file options.
+   * @param any_sidecar Set to true if at least one fresh sidecar exists
+   *        (the response then varies on Accept-Encoding).
+   * @return The sidecar, or nullopt to serve the file itself.
+   */
+  inline std::optional<Sidecar> find_sidecar(
+      const std::filesystem::path &full,
+      std::string_view accept,
+      const StaticFilesOptions &opt,
+      bool &any_sidecar)
+  {
+    any_sidecar = false;
+
+    const auto list = parse_accept_encoding(accept);
+    std::optional<Sidecar> best;
+    double best_q = 0.0;
+
+    for (const auto &encoding : opt.precompressed_encodings)
+    {
+      const std::string_view ext = sidecar_extension(encoding);
+      if (ext.empty())
+        continue;
+
+      std::filesystem::path side = full;
+      side += std::string(ext);
+      if (!sidecar_fresh(full, side))
+        continue;
+
+      any_sidecar = true;
+
+      const double q = accepted_q(list, encoding);
+      if (q > best_q)
+      {
+        best = Sidecar{encoding, std::move(side)};
+        best_q = q;
+      }
+    }
+
+    if (best)
+    {
+      for (const auto &ac : list)
+      {
+        if (ac.coding == "identity" && ac.q > best_q)
+          return std::nullopt;
+      }
+    }
+
+    return best;
+  }
+
+  /**
+   * @brief Compression levels used for sidecars: maximum quality, since
+   * they are built once and served many times.
+   */
+  inline CompressionOptions sidecar_compression()
+  {
+    CompressionOptions copt{};
+    copt.brotli_quality = 11;
+    copt.gzip_level = 9;
+    copt.zstd_level = 19;
+    return copt;
+  }
+
+  /**
+   * @brief Create or refresh missing/stale sidecars under @p root.
+   *
+   * Walks @p root recursively and, for each file whose type passes the
+   * compression policy of @p copt and which is at least copt.min_size
+   * bytes, writes one sidecar per coding of opt.precompressed_encodings
+   * that is compiled in. Sidecars that would not be smaller than the
+   * source are not written. Each sidecar is written to a temporary file
+   * and renamed, so a concurrent static_files() never reads a partial one.
+   *
+   * @param root Root directory on disk.
+   * @param opt Static file options (codings).
+   * @param copt Codec levels and type policy.
+   * @return Counters.
+   */
+  inline SidecarReport generate_sidecars(
+      const std::filesystem::path &root,
+      const StaticFilesOptions &opt = {},
+      const CompressionOptions &copt = sidecar_compression())
+  {
+    SidecarReport report;
+
+    auto is_sidecar = [](const std::filesystem::path &p)
+    {
+      const std::string ext = p.extension().string();
+      return ext == ".br" || ext == ".zst" || ext == ".gz";
+    };
+
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(root, ec), end;
+
+    for (; !ec && it != end; it.increment(ec))
+    {
+      const std::filesystem::path &src = it->path();
+      if (!it->is_regular_file(ec) || is_sidecar(src) || src.filename().string().find(".tmp-") != std::string::npos)
+        continue;
+
+      ++report.scanned;
+
+      if (!is_compressible_type(ext_to_mime(src.extension().string()), copt))
+      {
+        ++report.skipped;
+        continue;
+      }
+
+      std::string body;
+      bool loaded = false;
+
+      for (const auto &encoding : opt.precompressed_encodings)
+      {
+        const std::string_view ext = sidecar_extension(encoding);
+        if (ext.empty() || !encoding_available(encoding))
+          continue;
+
+        std::filesystem::path side = src;
+        side += std::string(ext);
+
+        if (sidecar_fresh(src, side))
+        {
+          ++report.fresh;
+          continue;
+        }
+
+        if (!loaded)
+        {
+          if (!read_file_to_string(src, body))
+          {
+            ++report.failed;
+            break;
+          }
+          loaded = true;
+        }
+
+        if (body.size() < copt.min_size)
+        {
+          ++report.skipped;
+          break;
+        }
+
+        std::string packed;
+        if (!compress_with(encoding, body, packed, copt))
+        {
+          ++report.failed;
+          continue;
+        }
+
+        if (packed.size() >= body.size())
+        {
+          ++report.skipped;
+          continue;
+        }
+
+        std::filesystem::path tmp = side;
+        tmp += ".tmp-vix";
+
+        {
+          std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+          out.write(packed.data(), static_cast<std::streamsize>(packed.size()));
+          if (!out)
+          {
+            ++report.failed;
+            continue;
+          }
+        }
+
+        std::error_code rename_ec;
+        std::filesystem::rename(tmp, side, rename_ec);
+        if (rename_ec)
+        {
+          std::filesystem::remove(tmp, rename_ec);
+          ++report.failed;
+          continue;
+        }
+
+        ++report.written;
+      }
+    }
+
+    return report;
+  }
+
+  /**
+   * @brief Run generate_sidecars() on an executor (e.g. at startup).
+   *
+   * static_files() keeps serving the plain files (or the sidecars already
+   * present) while the job runs.
+   *
+   * @param ex Executor running the job.
+   * @param root Root directory on disk.
+   * @param opt Static file options.
+   * @param done Optional callback receiving the report.
+   * @param copt Codec levels and type policy.
+   * @return false if the executor rejected the job.
+   */
+  inline bool generate_sidecars_async(
+      vix::executor::IExecutor &ex,
+      std::filesystem::path root,
+      StaticFilesOptions opt = {},
+      std::function<void(const SidecarReport &)> done = {},
+      CompressionOptions copt = sidecar_compression())
+  {
+    return ex.post(
+        [root = std::move(root), opt = std::move(opt), done = std::move(done), copt = std::move(copt)]()
+        {
+          const SidecarReport report = generate_sidecars(root, opt, copt);
+          if (done)
+            done(report);
+        });
+  }
+
   /**
    * @brief Static file serving middleware.
    *
@@ -164,6 +462,9 @@ namespace vix::middleware::performance
    *   - else: returns 404
    * - On success:
    *   - sets Content-Type based on file extension
+   *   - if precompressed is set and a fresh sidecar matches Accept-Encoding,
+   *     serves it with Content-Encoding (see find_sidecar()); "Vary:
+   *     Accept-Encoding" is added whenever sidecars exist
    *   - optionally sets Cache-Control
    *   - for HEAD: returns headers only
    *   - for GET: sends file contents as the body
@@ -219,8 +520,13 @@ namespace vix::middleware::performance
         return;
       }
 
+      std::optional<Sidecar> sidecar;
+      bool any_sidecar = false;
+      if (opt.precompressed)
+        sidecar = find_sidecar(full, ctx.req().header("accept-encoding"), opt, any_sidecar);
+
       std::string body;
-      if (!read_file_to_string(full, body))
+      if (!read_file_to_string(sidecar ? sidecar->path : full, body))
       {
         ctx.res().status(500).text("Static read error");
         return;
@@ -229,6 +535,12 @@ namespace vix::middleware::performance
       const std::string mime = ext_to_mime(full.extension().string());
       ctx.res().header("Content-Type", mime);
 
+      if (sidecar)
+        ctx.res().header("Content-Encoding", sidecar->encoding);
+
+      if (any_sidecar)
+        add_vary_accept_encoding(ctx.res());
+
       if (opt.add_cache_control)
         ctx.res().header("Cache-Control", opt.cache_control);
 
@@ -0,0 +1,83 @@
+/**
+ *
+ *  @file body.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#ifndef VIX_BODY_HPP
+#define VIX_BODY_HPP
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace vix::middleware::utils
+{
+  /**
+   * @brief Borrow the body of a request or response without copying it.
+   *
+   * The view aliases the message's storage: it stays valid until the body
+   * is replaced or the message is destroyed. Only messages whose body()
+   * returns a reference are accepted, so the view never outlives a
+   * temporary.
+   *
+   * @param msg vix::http::Request or vix::http::Response.
+   * @return View of the body bytes.
+   */
+  template <class Message>
+  inline std::string_view body_view(const Message &msg) noexcept
+  {
+    static_assert(std::is_lvalue_reference_v<decltype(msg.body())>,
+                  "body_view() requires body() to return a reference");
+
+    return std::string_view(msg.body());
+  }
+
+  /**
+   * @brief Replace a response body in place, taking ownership of @p body.
+   *
+   * The new bytes are moved into the response; views obtained with
+   * body_view() before the call are invalidated.
+   *
+   * @param res vix::http::Response.
+   * @param body New body.
+   */
+  template <class Message>
+  inline void replace_body(Message &res, std::string &&body)
+  {
+    res.set_body(std::move(body));
+  }
+
+  /**
+   * @brief Request state marking a response whose body is streamed.
+   *
+   * Set by performance::BodyStream once it commits the response headers.
+   * The body is then produced chunk by chunk, so middlewares that
+   * post-process a buffered body must leave the response alone.
+   */
+  struct StreamedBody
+  {
+  };
+
+  /**
+   * @brief Check whether the response to @p req is streamed.
+   *
+   * @param req vix::http::Request.
+   * @return true once a BodyStream has started.
+   */
+  template <class Message>
+  inline bool body_streamed(Message &req)
+  {
+    return req.template try_state<StreamedBody>() != nullptr;
+  }
+
+} // namespace vix::middleware::utils
+
+#endif // VIX_BODY_HPP
@@ -0,0 +1,155 @@
+/**
+ *
+ *  @file cache_metrics_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vix/http/Request.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/http/ResponseWrapper.hpp>
+#include <vix/middleware/cache/cache_metrics.hpp>
+#include <vix/middleware/cache/tinylfu_store.hpp>
+#include <vix/middleware/http_cache.hpp>
+#include <vix/middleware/observability/metrics.hpp>
+#include <vix/cache/Cache.hpp>
+#include <vix/cache/CachePolicy.hpp>
+
+using namespace vix::middleware;
+using vix::middleware::cache::CacheEvent;
+using vix::middleware::cache::CacheMetrics;
+using vix::middleware::cache::CacheMetricsOptions;
+
+static void test_counters_across_threads()
+{
+  CacheMetricsOptions opt{};
+  opt.path_prefixes = {"/api/", "/api/users/"};
+  CacheMetrics m(opt);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&]()
+                         {
+                           for (int i = 0; i < 1000; ++i)
+                           {
+                             m.record(CacheEvent::Hit, "/api/users/1", "k");
+                             m.record(CacheEvent::Miss, "/api/posts", "p");
+                           } });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  m.record(CacheEvent::Bypass, "/static/x", {});
+
+  auto s = m.snapshot();
+  assert(s.hits == 4000);
+  assert(s.misses == 4000);
+  assert(s.bypasses == 1);
+  assert(s.hit_ratio == 0.5);
+
+  assert(s.prefixes.size() == 3);
+  assert(s.prefixes[0].prefix == "/api/" && s.prefixes[0].misses == 4000 && s.prefixes[0].hits == 0);
+  assert(s.prefixes[1].prefix == "/api/users/" && s.prefixes[1].hits == 4000);
+  assert(s.prefixes[1].hit_ratio == 1.0);
+  assert(s.prefixes[2].prefix == "other");
+
+  std::cout << "[OK] cache_metrics: sharded counters and per-prefix hit ratio\n";
+}
+
+static void test_top_keys()
+{
+  CacheMetricsOptions opt{};
+  opt.top_k = 2;
+  opt.hit_sample_every = 1;
+  CacheMetrics m(opt);
+
+  for (int i = 0; i < 50; ++i)
+    m.record(CacheEvent::Hit, "/", "hot");
+  for (int i = 0; i < 20; ++i)
+    m.record(CacheEvent::Hit, "/", "warm");
+  for (int i = 0; i < 30; ++i)
+    m.record(CacheEvent::Hit, "/", "cold" + std::to_string(i));
+
+  m.record(CacheEvent::Store, "/", "small", 10);
+  m.record(CacheEvent::Store, "/", "big", 10'000);
+  m.record(CacheEvent::Store, "/", "medium", 500);
+
+  auto s = m.snapshot();
+  assert(s.top_hits.size() == 2);
+  assert(s.top_hits[0].key == "hot");
+  assert(s.top_sizes.size() == 2);
+  assert(s.top_sizes[0].key == "big" && s.top_sizes[0].value == 10'000);
+  assert(s.top_sizes[1].key == "medium");
+
+  std::cout << "[OK] cache_metrics: top keys by hits and by size\n";
+}
+
+static void test_http_cache_flushes_to_sink()
+{
+  auto sink = std::make_shared<observability::InMemoryMetrics>();
+
+  CacheMetricsOptions mopt{};
+  mopt.flush_interval_ms = 0;
+  auto metrics = std::make_shared<CacheMetrics>(mopt, sink);
+
+  auto store = std::make_shared<cache::TinyLfuStore>();
+  metrics->attach_usage(store);
+
+  vix::cache::CachePolicy policy;
+  policy.ttl_ms = 60'000;
+  auto c = std::make_shared<vix::cache::Cache>(policy, store);
+
+  HttpCacheOptions opt{};
+  opt.metrics = metrics;
+  auto mw = http_cache(c, opt);
+
+  for (int i = 0; i < 3; ++i)
+  {
+    vix::http::Request::HeaderMap h;
+    h.emplace("Host", "localhost");
+    vix::http::Request req("GET", "/api/x", std::move(h), {});
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    mw(req, w, [&]()
+       { w.ok().text("payload"); });
+  }
+
+  metrics->flush();
+
+  auto s = metrics->snapshot();
+  assert(s.hits == 2 && s.misses == 1 && s.stores == 1);
+  assert(s.usage.entries == 1);
+  assert(s.usage.bytes > 0);
+
+  assert(sink->counter("vix_http_cache_hits_total") == 2);
+  assert(sink->counter("vix_http_cache_misses_total") == 1);
+  assert(sink->counter("vix_http_cache_stores_total") == 1);
+  assert(sink->gauge("vix_http_cache_entries") == 1.0);
+  assert(sink->gauge("vix_http_cache_bytes") > 0.0);
+
+  std::cout << "[OK] cache_metrics: http_cache events pushed to IMetricsSink\n";
+}
+
+int main()
+{
+  test_counters_across_threads();
+  test_top_keys();
+  test_http_cache_flushes_to_sink();
+
+  std::cout << "OK: cache_metrics smoke tests passed\n";
+  return 0;
+}
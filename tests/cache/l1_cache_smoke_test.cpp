@@ -0,0 +1,161 @@
+/**
+ *
+ *  @file l1_cache_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <vix/http/Request.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/http/ResponseWrapper.hpp>
+#include <vix/middleware/cache/l1_cache.hpp>
+#include <vix/middleware/cache/tag_index.hpp>
+#include <vix/middleware/http_cache.hpp>
+#include <vix/cache/Cache.hpp>
+#include <vix/cache/CachePolicy.hpp>
+#include <vix/cache/MemoryStore.hpp>
+
+using namespace vix::middleware;
+using vix::middleware::cache::L1Cache;
+using vix::middleware::cache::L1CacheOptions;
+using vix::middleware::cache::make_shared_entry;
+
+static vix::cache::CacheEntry entry(std::string body)
+{
+  vix::cache::CacheEntry e;
+  e.status = 200;
+  e.body = std::move(body);
+  return e;
+}
+
+static void test_get_put_and_expiry()
+{
+  L1CacheOptions opt{};
+  opt.capacity = 8;
+  opt.ttl_ms = 100;
+  L1Cache l1(opt);
+
+  assert(!l1.get("k", 0));
+
+  l1.put("k", make_shared_entry(entry("v1")), 0);
+  assert(l1.get("k", 50));
+  assert(l1.get("k", 50)->body == "v1");
+
+  l1.put("k", make_shared_entry(entry("v2")), 50);
+  assert(l1.get("k", 60)->body == "v2");
+
+  assert(!l1.get("k", 150));
+  assert(!l1.get("k", 60));
+
+  std::cout << "[OK] l1: get/put and ttl\n";
+}
+
+static void test_epochs_invalidate()
+{
+  L1Cache l1;
+
+  l1.put("a", make_shared_entry(entry("a")), 0, 7);
+  assert(l1.get("a", 1, 7));
+  assert(!l1.get("a", 1, 8));
+
+  l1.put("b", make_shared_entry(entry("b")), 0);
+  l1.bump();
+  assert(!l1.get("b", 1));
+
+  L1CacheOptions small{};
+  small.max_entry_bytes = 4;
+  L1Cache l1s(small);
+  l1s.put("big", make_shared_entry(entry("too large")), 0);
+  assert(!l1s.get("big", 1));
+
+  std::cout << "[OK] l1: epochs and size limit\n";
+}
+
+static void test_tables_are_per_thread()
+{
+  L1Cache l1;
+  l1.put("k", make_shared_entry(entry("main")), 0);
+
+  bool seen = true;
+  std::thread t([&]()
+                { seen = static_cast<bool>(l1.get("k", 1)); });
+  t.join();
+
+  assert(!seen);
+  assert(l1.get("k", 1));
+
+  std::cout << "[OK] l1: tables are per thread\n";
+}
+
+static vix::http::Request make_req(std::string target)
+{
+  vix::http::Request::HeaderMap map;
+  map.emplace("Host", "localhost");
+  return vix::http::Request("GET", std::move(target), std::move(map), std::string{});
+}
+
+static void test_http_cache_l1()
+{
+  auto store = std::make_shared<vix::cache::MemoryStore>();
+  vix::cache::CachePolicy policy;
+  policy.ttl_ms = 60'000;
+  auto c = std::make_shared<vix::cache::Cache>(policy, store);
+
+  auto index = std::make_shared<vix::middleware::cache::CacheTagIndex>(store);
+
+  HttpCacheOptions opt{};
+  opt.l1 = std::make_shared<L1Cache>();
+  opt.tag_index = index;
+  auto mw = http_cache(c, opt);
+
+  int calls = 0;
+  auto run = [&]()
+  {
+    auto req = make_req("/api/hot");
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    mw(req, w, [&]()
+       {
+         calls++;
+         w.status(200).header("Surrogate-Key", "hot").text("v" + std::to_string(calls)); });
+    return res;
+  };
+
+  assert(run().body() == "v1");
+  assert(run().body() == "v1"); // shared hit, copied into L1
+
+  // Served from L1 even though the shared store lost the entry.
+  store->clear();
+  auto res = run();
+  assert(res.body() == "v1");
+  assert(res.header("x-vix-cache-status") == "hit");
+  assert(calls == 1);
+
+  index->invalidate_tag("hot");
+  assert(run().body() == "v2");
+  assert(calls == 2);
+
+  std::cout << "[OK] l1: http_cache serves hot keys from L1\n";
+}
+
+int main()
+{
+  test_get_put_and_expiry();
+  test_epochs_invalidate();
+  test_tables_are_per_thread();
+  test_http_cache_l1();
+
+  std::cout << "OK: l1 cache smoke tests passed\n";
+  return 0;
+}
@@ -0,0 +1,299 @@
+/**
+ *
+ *  @file mmap_store_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <vix/cache/CacheEntry.hpp>
+#include <vix/cache/MemoryStore.hpp>
+#include <vix/middleware/cache/mmap_store.hpp>
+#include <vix/middleware/cache/tiered_store.hpp>
+#include <vix/middleware/utils/clock.hpp>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+using namespace vix::middleware::cache;
+
+static std::string temp_path(const std::string &name)
+{
+  auto p = std::filesystem::temp_directory_path() / ("vix_" + name + ".dat");
+  std::filesystem::remove(p);
+  return p.string();
+}
+
+static vix::cache::CacheEntry make_entry(const std::string &body)
+{
+  vix::cache::CacheEntry e;
+  e.status = 200;
+  e.body = body;
+  e.headers["content-type"] = "text/plain";
+  e.created_at_ms = vix::middleware::utils::Clock::now_ms_steady() - 5'000;
+  return e;
+}
+
+static void test_put_get_roundtrip()
+{
+  MmapStoreOptions opt{};
+  opt.path = temp_path("mmap_roundtrip");
+  MmapStore store(opt);
+  assert(store.is_open());
+
+  store.put("a", make_entry("alpha"));
+  store.put("b", make_entry(std::string(100'000, 'b')));
+
+  auto a = store.get("a");
+  assert(a.has_value());
+  assert(a->status == 200);
+  assert(a->body == "alpha");
+  assert(a->headers.at("content-type") == "text/plain");
+
+  const std::int64_t age = vix::middleware::utils::Clock::now_ms_steady() - a->created_at_ms;
+  assert(age >= 5'000 && age < 60'000);
+
+  auto b = store.get("b");
+  assert(b.has_value() && b->body.size() == 100'000);
+  assert(!store.get("missing").has_value());
+
+  std::filesystem::remove(opt.path);
+  std::cout << "[OK] mmap_store: put/get roundtrip\n";
+}
+
+static void test_survives_reopen()
+{
+  MmapStoreOptions opt{};
+  opt.path = temp_path("mmap_reopen");
+
+  {
+    MmapStore store(opt);
+    store.put("keep", make_entry("v1"));
+    store.put("keep", make_entry("v2"));
+    store.put("gone", make_entry("x"));
+    store.erase("gone");
+  }
+
+  {
+    MmapStore store(opt);
+    assert(store.size() == 1);
+    assert(store.stats().recovered == 1);
+
+    auto e = store.get("keep");
+    assert(e.has_value() && e->body == "v2");
+    assert(!store.get("gone").has_value());
+  }
+
+  std::filesystem::remove(opt.path);
+  std::cout << "[OK] mmap_store: index survives reopen\n";
+}
+
+static void test_torn_tail_is_truncated()
+{
+  MmapStoreOptions opt{};
+  opt.path = temp_path("mmap_torn");
+
+  {
+    MmapStore store(opt);
+    store.put("a", make_entry("alpha"));
+    store.put("b", make_entry("beta"));
+  }
+
+  const auto full = std::filesystem::file_size(opt.path);
+  std::filesystem::resize_file(opt.path, full - 3);
+
+  {
+    MmapStore store(opt);
+    assert(store.size() == 1);
+    assert(store.get("a").has_value());
+    assert(!store.get("b").has_value());
+
+    store.put("c", make_entry("gamma"));
+  }
+
+  {
+    MmapStore store(opt);
+    assert(store.size() == 2);
+    assert(store.get("c")->body == "gamma");
+  }
+
+  std::filesystem::remove(opt.path);
+  std::cout << "[OK] mmap_store: torn tail truncated on open\n";
+}
+
+static void test_budget_and_compaction()
+{
+  MmapStoreOptions opt{};
+  opt.path = temp_path("mmap_compact");
+  opt.max_bytes = 16 * 1024;
+  opt.compact_min_bytes = 4 * 1024;
+
+  {
+    MmapStore store(opt);
+    for (int i = 0; i < 200; ++i)
+      store.put("k" + std::to_string(i % 40), make_entry(std::string(500, 'x')));
+
+    auto s = store.stats();
+    assert(s.live_bytes <= opt.max_bytes);
+    assert(s.evictions > 0);
+    assert(s.compactions > 0);
+    assert(s.file_bytes < 3 * opt.max_bytes);
+    assert(store.get("k39").has_value());
+  }
+
+  {
+    MmapStore store(opt);
+    assert(store.get("k39").has_value());
+  }
+
+  std::filesystem::remove(opt.path);
+  std::cout << "[OK] mmap_store: byte budget and compaction\n";
+}
+
+static void test_flushes_are_batched()
+{
+  MmapStoreOptions opt{};
+  opt.path = temp_path("mmap_batched");
+  opt.flush_bytes = 64 * 1024;
+
+  {
+    MmapStore store(opt);
+    const auto empty = std::filesystem::file_size(opt.path);
+
+    store.put("a", make_entry("alpha"));
+    store.put("b", make_entry("beta"));
+    assert(std::filesystem::file_size(opt.path) == empty);
+
+    // Reading a buffered record writes the batch out first.
+    assert(store.get("b")->body == "beta");
+    const auto after_read = std::filesystem::file_size(opt.path);
+    assert(after_read > empty);
+
+    // Tombstones are never left in the buffer.
+    store.erase("a");
+    assert(!store.get("a").has_value());
+    assert(std::filesystem::file_size(opt.path) == store.stats().file_bytes);
+
+    // A full batch is written without a read.
+    store.put("big", make_entry(std::string(opt.flush_bytes, 'x')));
+    assert(std::filesystem::file_size(opt.path) > after_read + opt.flush_bytes);
+
+    store.put("c", make_entry("gamma"));
+    assert(store.flush());
+    assert(std::filesystem::file_size(opt.path) == store.stats().file_bytes);
+    store.put("d", make_entry("delta"));
+  }
+
+  {
+    // Closing writes whatever was still buffered.
+    MmapStore store(opt);
+    assert(store.size() == 4);
+    assert(!store.get("a").has_value());
+    assert(store.get("d")->body == "delta");
+  }
+
+  std::filesystem::remove(opt.path);
+  std::cout << "[OK] mmap_store: appends are flushed in batches\n";
+}
+
+static void test_failed_write_keeps_erasures()
+{
+#if !defined(_WIN32)
+  MmapStoreOptions opt{};
+  opt.path = temp_path("mmap_rollback");
+  opt.flush_bytes = 0;
+
+  rlimit saved{};
+  getrlimit(RLIMIT_FSIZE, &saved);
+  auto old_handler = std::signal(SIGXFSZ, SIG_IGN);
+
+  {
+    MmapStore store(opt);
+    store.put("a", make_entry("old"));
+    store.put("b", make_entry("kept"));
+
+    // Room for a tombstone, not for the new record.
+    rlimit lim = saved;
+    lim.rlim_cur = static_cast<rlim_t>(std::filesystem::file_size(opt.path) + 256);
+    setrlimit(RLIMIT_FSIZE, &lim);
+
+    store.put("a", make_entry(std::string(64 * 1024, 'n')));
+    setrlimit(RLIMIT_FSIZE, &saved);
+
+    assert(!store.get("a").has_value());
+    assert(store.get("b")->body == "kept");
+  }
+
+  std::signal(SIGXFSZ, old_handler);
+
+  {
+    // The overwritten record must not come back.
+    MmapStore store(opt);
+    assert(!store.get("a").has_value());
+    assert(store.get("b")->body == "kept");
+  }
+
+  std::filesystem::remove(opt.path);
+  std::cout << "[OK] mmap_store: failed write keeps earlier erasures\n";
+#endif
+}
+
+static void test_tiered_store_promotes_and_restores()
+{
+  MmapStoreOptions opt{};
+  opt.path = temp_path("mmap_tiered");
+
+  {
+    TieredStore store(std::make_shared<vix::cache::MemoryStore>(),
+                      std::make_shared<MmapStore>(opt));
+    store.put("k", make_entry("warm"));
+    assert(store.get("k")->body == "warm");
+    assert(store.stats().hot_hits == 1);
+  }
+
+  {
+    // Fresh process: empty memory tier, warm disk tier.
+    TieredStore store(std::make_shared<vix::cache::MemoryStore>(),
+                      std::make_shared<MmapStore>(opt));
+
+    assert(store.get("k")->body == "warm");
+    assert(store.get("k")->body == "warm");
+
+    auto s = store.stats();
+    assert(s.cold_hits == 1);
+    assert(s.hot_hits == 1);
+
+    store.erase("k");
+    assert(!store.get("k").has_value());
+  }
+
+  std::filesystem::remove(opt.path);
+  std::cout << "[OK] tiered_store: cold hits promoted, disk tier survives restart\n";
+}
+
+int main()
+{
+  test_put_get_roundtrip();
+  test_survives_reopen();
+  test_torn_tail_is_truncated();
+  test_budget_and_compaction();
+  test_flushes_are_batched();
+  test_failed_write_keeps_erasures();
+  test_tiered_store_promotes_and_restores();
+
+  std::cout << "OK: mmap_store smoke tests passed\n";
+  return 0;
+}
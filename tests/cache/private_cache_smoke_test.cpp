@@ -0,0 +1,249 @@
+/**
+ *
+ *  @file private_cache_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <vix/http/Request.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/http/ResponseWrapper.hpp>
+#include <vix/middleware/auth/principal.hpp>
+#include <vix/middleware/cache/private_cache.hpp>
+#include <vix/middleware/cache/tag_index.hpp>
+#include <vix/middleware/http_cache.hpp>
+#include <vix/cache/Cache.hpp>
+#include <vix/cache/CachePolicy.hpp>
+#include <vix/cache/MemoryStore.hpp>
+
+using namespace vix::middleware;
+using vix::middleware::cache::CacheTagIndex;
+using vix::middleware::cache::make_shared_entry;
+using vix::middleware::cache::PrivateCache;
+using vix::middleware::cache::PrivateCacheOptions;
+
+static vix::middleware::cache::SharedEntry entry(std::size_t size, std::int64_t created = 0)
+{
+  vix::cache::CacheEntry e;
+  e.status = 200;
+  e.body = std::string(size, 'x');
+  e.created_at_ms = created;
+  return make_shared_entry(std::move(e));
+}
+
+static void test_partitions_are_isolated()
+{
+  PrivateCache pc;
+
+  assert(pc.put("alice", "GET /me", entry(10)));
+  assert(pc.get("alice", "GET /me", 1));
+  assert(!pc.get("bob", "GET /me", 1));
+
+  pc.erase_principal("alice");
+  assert(!pc.get("alice", "GET /me", 1));
+
+  std::cout << "[OK] private_cache: partitions are isolated\n";
+}
+
+static void test_quota_and_lru()
+{
+  PrivateCacheOptions opt{};
+  opt.max_bytes_per_principal = 1000;
+  PrivateCache pc(opt);
+
+  assert(pc.put("u", "a", entry(300)));
+  assert(pc.put("u", "b", entry(300)));
+  assert(pc.get("u", "a", 1)); // a is now most recent
+  assert(pc.put("u", "c", entry(300)));
+
+  assert(pc.get("u", "a", 1));
+  assert(!pc.get("u", "b", 1));
+  assert(pc.get("u", "c", 1));
+  assert(pc.principal_bytes("u") <= opt.max_bytes_per_principal);
+
+  assert(!pc.put("u", "huge", entry(5000)));
+
+  // Another principal's quota is untouched.
+  assert(pc.put("v", "a", entry(300)));
+  assert(pc.get("u", "a", 1));
+  assert(pc.stats().evictions == 1);
+
+  std::cout << "[OK] private_cache: per-principal quota and LRU\n";
+}
+
+static void test_principal_bound_and_ttl()
+{
+  PrivateCacheOptions opt{};
+  opt.max_principals = 2;
+  opt.stripes = 1;
+  opt.ttl_ms = 100;
+  PrivateCache pc(opt);
+
+  pc.put("p1", "k", entry(10));
+  pc.put("p2", "k", entry(10));
+  assert(pc.get("p1", "k", 1)); // p2 is now the least recently active
+  pc.put("p3", "k", entry(10));
+
+  assert(pc.get("p1", "k", 1));
+  assert(!pc.get("p2", "k", 1));
+  assert(pc.stats().principals == 2);
+  assert(pc.stats().principals_evicted == 1);
+
+  assert(!pc.get("p1", "k", 100));
+  assert(pc.usage().entries == 1);
+
+  std::cout << "[OK] private_cache: principal bound and ttl\n";
+}
+
+static vix::http::Request make_req(std::string target, std::string user = {})
+{
+  vix::http::Request::HeaderMap map;
+  map.emplace("Host", "localhost");
+  if (!user.empty())
+    map.emplace("x-user", user);
+  return vix::http::Request("GET", std::move(target), std::move(map), std::string{});
+}
+
+static void test_http_cache_private_mode()
+{
+  auto store = std::make_shared<vix::cache::MemoryStore>();
+  vix::cache::CachePolicy policy;
+  policy.ttl_ms = 60'000;
+  auto c = std::make_shared<vix::cache::Cache>(policy, store);
+
+  HttpCacheOptions opt{};
+  opt.private_cache = std::make_shared<PrivateCache>();
+  opt.principal = [](vix::http::Request &req)
+  { return req.header("x-user"); };
+  auto mw = http_cache(c, opt);
+
+  int calls = 0;
+  auto run = [&](vix::http::Request req, std::string cache_control = {})
+  {
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    mw(req, w, [&]()
+       {
+         calls++;
+         if (!cache_control.empty())
+           w.header("Cache-Control", cache_control);
+         w.status(200).text(req.header("x-user") + ":" + std::to_string(calls)); });
+    return res;
+  };
+
+  assert(run(make_req("/api/me", "alice")).body() == "alice:1");
+  auto again = run(make_req("/api/me", "alice"));
+  assert(again.body() == "alice:1");
+  assert(again.header("x-vix-cache-status") == "hit-private");
+
+  // Same URL, other user: never sees alice's entry.
+  assert(run(make_req("/api/me", "bob")).body() == "bob:2");
+  assert(calls == 2);
+
+  // Nothing authenticated reached the shared cache.
+  assert(run(make_req("/api/me")).body() == ":3");
+  assert(run(make_req("/api/me")).body() == ":3");
+
+  // Shared responses marked private or no-store are not stored.
+  assert(run(make_req("/api/p"), "private, max-age=60").body() == ":4");
+  assert(run(make_req("/api/p"), "private, max-age=60").body() == ":5");
+  assert(run(make_req("/api/n", "alice"), "no-store").body() == "alice:6");
+  assert(run(make_req("/api/n", "alice"), "no-store").body() == "alice:7");
+
+  std::cout << "[OK] private_cache: http_cache private mode\n";
+}
+
+static void test_private_entries_are_invalidated()
+{
+  vix::cache::CachePolicy policy;
+  policy.ttl_ms = 60'000;
+  auto c = std::make_shared<vix::cache::Cache>(policy, std::make_shared<vix::cache::MemoryStore>());
+
+  HttpCacheOptions opt{};
+  opt.private_cache = std::make_shared<PrivateCache>();
+  opt.principal = [](vix::http::Request &req)
+  { return req.header("x-user"); };
+  opt.tag_index = std::make_shared<CacheTagIndex>();
+  opt.tag_index->attach_private_cache(opt.private_cache);
+  auto mw = http_cache(c, opt);
+
+  int calls = 0;
+  auto run = [&](vix::http::Request req)
+  {
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    mw(req, w, [&]()
+       {
+         calls++;
+         w.header("Surrogate-Key", "dashboard user:" + req.header("x-user"));
+         w.status(200).text(std::to_string(calls)); });
+    return res;
+  };
+
+  run(make_req("/api/dashboard", "alice"));
+  run(make_req("/api/dashboard", "bob"));
+  auto hit = run(make_req("/api/dashboard", "alice"));
+  assert(hit.header("x-vix-cache-status") == "hit-private");
+  assert(hit.body() == "1");
+  assert(hit.header("Surrogate-Key").empty());
+  assert(opt.private_cache->usage().entries == 2);
+
+  // Tags of both users are indexed; alice's tag drops the key for everyone.
+  assert(opt.tag_index->invalidate_tag("user:alice") == 1);
+  assert(opt.private_cache->usage().entries == 0);
+
+  // Entries created in the invalidation's millisecond count as invalidated.
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  auto miss = run(make_req("/api/dashboard", "bob"));
+  assert(miss.header("x-vix-cache-status") == "miss-private");
+  assert(miss.body() == "3");
+  assert(run(make_req("/api/dashboard", "bob")).header("x-vix-cache-status") == "hit-private");
+
+  // Without the private cache attached, hits are still checked.
+  opt.tag_index->attach_private_cache(nullptr);
+  opt.tag_index->invalidate_prefix("/api/");
+  assert(opt.private_cache->usage().entries == 1);
+  assert(run(make_req("/api/dashboard", "bob")).header("x-vix-cache-status") == "miss-private");
+
+  std::cout << "[OK] private_cache: tag and prefix invalidation\n";
+}
+
+static void test_api_key_principal_is_hashed()
+{
+  auto req = make_req("/api/me");
+  assert(auth::request_principal(req).empty());
+
+  req.emplace_state<auth::ApiKey>(auth::ApiKey{"secret"});
+  const std::string id = auth::request_principal(req);
+
+  // "key:" + sha256("secret"), never the key itself.
+  assert(id == "key:2bb80d537b1da3e38bd30361aa855686bde0eacd7162fef6a25fe97bf527a25b");
+  assert(id.find("secret") == std::string::npos);
+
+  std::cout << "[OK] private_cache: api key principal is hashed\n";
+}
+
+int main()
+{
+  test_partitions_are_isolated();
+  test_quota_and_lru();
+  test_principal_bound_and_ttl();
+  test_http_cache_private_mode();
+  test_private_entries_are_invalidated();
+  test_api_key_principal_is_hashed();
+
+  std::cout << "OK: private_cache smoke tests passed\n";
+  return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ *
+ *  @file query_key_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <vix/http/Request.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/http/ResponseWrapper.hpp>
+#include <vix/middleware/cache/query_key.hpp>
+#include <vix/middleware/http_cache.hpp>
+#include <vix/cache/Cache.hpp>
+#include <vix/cache/CachePolicy.hpp>
+#include <vix/cache/MemoryStore.hpp>
+
+using namespace vix::middleware;
+using vix::middleware::cache::canonicalize_query;
+using vix::middleware::cache::QueryKeyOptions;
+
+static void test_disabled_keeps_raw_query()
+{
+  QueryKeyOptions opt{};
+  assert(canonicalize_query("b=2&a=1&&x", opt) == "b=2&a=1&&x");
+
+  std::cout << "[OK] query_key: disabled keeps raw query\n";
+}
+
+static void test_sort_is_stable()
+{
+  QueryKeyOptions opt{};
+  opt.sort = true;
+
+  assert(canonicalize_query("b=2&a=1", opt) == "a=1&b=2");
+  assert(canonicalize_query("tag=z&id=1&tag=a", opt) == "id=1&tag=z&tag=a");
+  assert(canonicalize_query("a=1&&b", opt) == "a=1&b");
+
+  std::cout << "[OK] query_key: sorted, stable for repeated names\n";
+}
+
+static void test_ignore_and_allow_lists()
+{
+  QueryKeyOptions opt{};
+  opt.ignore = cache::tracking_query_params();
+
+  assert(canonicalize_query("id=7&utm_source=x&utm_medium=y&fbclid=z", opt) == "id=7");
+  assert(canonicalize_query("utm%5Fcampaign=q&id=7", opt) == "id=7");
+  assert(canonicalize_query("utm_source=x", opt).empty());
+
+  QueryKeyOptions allow{};
+  allow.allow = {"page", "filter_*"};
+  assert(canonicalize_query("page=2&session=abc&filter_color=red", allow) == "page=2&filter_color=red");
+
+  std::cout << "[OK] query_key: deny-list and allow-list\n";
+}
+
+static void test_percent_encoding_normalized()
+{
+  QueryKeyOptions opt{};
+  opt.normalize_encoding = true;
+
+  assert(canonicalize_query("q=%7euser%2fhome", opt) == "q=~user%2Fhome");
+  assert(canonicalize_query("q=%41%zz%4", opt) == "q=A%zz%4");
+  assert(cache::normalize_percent_encoding("a%2Db") == "a-b");
+
+  std::cout << "[OK] query_key: percent-encoding normalized\n";
+}
+
+static void test_http_cache_shares_entries()
+{
+  auto store = std::make_shared<vix::cache::MemoryStore>();
+  vix::cache::CachePolicy policy;
+  policy.ttl_ms = 60'000;
+  auto c = std::make_shared<vix::cache::Cache>(policy, store);
+
+  HttpCacheOptions opt{};
+  opt.query_key.sort = true;
+  opt.query_key.ignore = cache::tracking_query_params();
+  auto mw = http_cache(c, opt);
+
+  int next_calls = 0;
+  for (const char *target : {"/api/p?a=1&b=2",
+                             "/api/p?b=2&a=1",
+                             "/api/p?a=1&utm_source=news&b=2&fbclid=xyz"})
+  {
+    vix::http::Request::HeaderMap h;
+    h.emplace("Host", "localhost");
+    vix::http::Request req("GET", target, std::move(h), {});
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    mw(req, w, [&]()
+       {
+         next_calls++;
+         w.ok().text("page"); });
+
+    assert(res.body() == "page");
+  }
+
+  assert(next_calls == 1);
+
+  std::cout << "[OK] query_key: http_cache shares entries across equivalent URLs\n";
+}
+
+int main()
+{
+  test_disabled_keeps_raw_query();
+  test_sort_is_stable();
+  test_ignore_and_allow_lists();
+  test_percent_encoding_normalized();
+  test_http_cache_shares_entries();
+
+  std::cout << "OK: query_key smoke tests passed\n";
+  return 0;
+}
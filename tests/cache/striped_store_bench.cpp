@@ -0,0 +1,117 @@
+/**
+ *
+ *  @file striped_store_bench.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+// Read-heavy throughput of StripedStore vs vix::cache::MemoryStore.
+//
+// usage: middleware_striped_store_bench [threads] [ops_per_thread] [write_percent]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vix/cache/CacheEntry.hpp>
+#include <vix/cache/CacheStore.hpp>
+#include <vix/cache/MemoryStore.hpp>
+#include <vix/middleware/cache/striped_store.hpp>
+
+namespace
+{
+  constexpr int k_keys = 1024;
+
+  double run(vix::cache::CacheStore &store, int threads, int ops, int write_percent)
+  {
+    vix::cache::CacheEntry e;
+    e.status = 200;
+    e.body = std::string(512, 'x');
+    e.headers["content-type"] = "application/json";
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < k_keys; ++i)
+    {
+      keys.push_back("GET /api/items/" + std::to_string(i));
+      store.put(keys.back(), e);
+    }
+
+    std::atomic<bool> go{false};
+    std::atomic<std::uint64_t> sink{0};
+    std::vector<std::thread> pool;
+
+    for (int t = 0; t < threads; ++t)
+    {
+      pool.emplace_back([&, t]()
+                        {
+                          std::uint64_t x = 0x9E3779B97F4A7C15ull * static_cast<std::uint64_t>(t + 1);
+                          std::uint64_t local = 0;
+
+                          while (!go.load(std::memory_order_acquire))
+                            std::this_thread::yield();
+
+                          for (int i = 0; i < ops; ++i)
+                          {
+                            x ^= x << 13;
+                            x ^= x >> 7;
+                            x ^= x << 17;
+
+                            // Skewed toward the first keys, like real hot endpoints.
+                            const auto &key = keys[(x % k_keys) * (x % k_keys) / k_keys];
+
+                            if (static_cast<int>(x % 100) < write_percent)
+                              store.put(key, e);
+                            else if (auto hit = store.get(key))
+                              local += hit->body.size();
+                          }
+
+                          sink.fetch_add(local, std::memory_order_relaxed); });
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto &th : pool)
+      th.join();
+    const auto t1 = std::chrono::steady_clock::now();
+
+    const double s = std::chrono::duration<double>(t1 - t0).count();
+    return static_cast<double>(threads) * ops / s;
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  const int hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  const int threads = argc > 1 ? std::atoi(argv[1]) : hw;
+  const int ops = argc > 2 ? std::atoi(argv[2]) : 200'000;
+  const int write_percent = argc > 3 ? std::atoi(argv[3]) : 1;
+
+  std::cout << "threads=" << threads << " ops/thread=" << ops
+            << " writes=" << write_percent << "%\n";
+
+  for (int n = 1; n <= threads; n *= 2)
+  {
+    vix::cache::MemoryStore memory;
+    vix::middleware::cache::StripedStore striped;
+
+    const double m = run(memory, n, ops, write_percent);
+    const double s = run(striped, n, ops, write_percent);
+
+    std::cout << "  " << n << " thread(s): MemoryStore " << static_cast<std::uint64_t>(m)
+              << " ops/s, StripedStore " << static_cast<std::uint64_t>(s)
+              << " ops/s (x" << (s / m) << ")\n";
+  }
+
+  return 0;
+}
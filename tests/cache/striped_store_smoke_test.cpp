@@ -0,0 +1,110 @@
+/**
+ *
+ *  @file striped_store_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vix/cache/CacheEntry.hpp>
+#include <vix/middleware/cache/entry_bytes.hpp>
+#include <vix/middleware/cache/striped_store.hpp>
+
+using namespace vix::middleware::cache;
+
+static vix::cache::CacheEntry make_entry(std::string body)
+{
+  vix::cache::CacheEntry e;
+  e.status = 200;
+  e.body = std::move(body);
+  return e;
+}
+
+static void test_store_interface()
+{
+  StripedStoreOptions opt{};
+  opt.stripes = 5;
+  StripedStore store(opt);
+  assert(store.stripes() == 8);
+
+  assert(!store.get("a").has_value());
+
+  store.put("a", make_entry("one"));
+  store.put("b", make_entry("two"));
+  assert(store.get("a")->body == "one");
+  assert(store.size() == 2);
+
+  store.put("a", make_entry("uno"));
+  assert(store.get("a")->body == "uno");
+  assert(store.size() == 2);
+  assert(store.usage().bytes == entry_bytes("a", make_entry("uno")) + entry_bytes("b", make_entry("two")));
+
+  store.erase("a");
+  assert(!store.get("a").has_value());
+  assert(store.usage().bytes == entry_bytes("b", make_entry("two")));
+
+  store.clear();
+  assert(store.size() == 0);
+  assert(store.usage().bytes == 0);
+
+  std::cout << "[OK] striped_store: CacheStore semantics\n";
+}
+
+static void test_concurrent_readers_and_writers()
+{
+  StripedStore store;
+  for (int i = 0; i < 256; ++i)
+    store.put("k" + std::to_string(i), make_entry("v" + std::to_string(i)));
+
+  std::atomic<bool> bad{false};
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&, t]()
+                         {
+                           for (int i = 0; i < 20'000; ++i)
+                           {
+                             const int k = (i * 7 + t) % 256;
+                             const std::string key = "k" + std::to_string(k);
+
+                             if (t == 0 && i % 10 == 0)
+                             {
+                               store.put(key, make_entry("v" + std::to_string(k)));
+                               continue;
+                             }
+
+                             auto e = store.get_shared(key);
+                             if (!e || e->body != "v" + std::to_string(k))
+                               bad.store(true);
+                           } });
+  }
+
+  for (auto &th : threads)
+    th.join();
+
+  assert(!bad.load());
+  assert(store.size() == 256);
+
+  std::cout << "[OK] striped_store: concurrent readers and writers\n";
+}
+
+int main()
+{
+  test_store_interface();
+  test_concurrent_readers_and_writers();
+
+  std::cout << "OK: striped_store smoke tests passed\n";
+  return 0;
+}
@@ -0,0 +1,223 @@
+/**
+ *
+ *  @file tag_index_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <chrono>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <vix/http/Request.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/http/ResponseWrapper.hpp>
+#include <vix/middleware/cache/tag_index.hpp>
+#include <vix/middleware/http_cache.hpp>
+#include <vix/cache/Cache.hpp>
+#include <vix/cache/CacheEntry.hpp>
+#include <vix/cache/CachePolicy.hpp>
+#include <vix/cache/MemoryStore.hpp>
+
+using namespace vix::middleware;
+
+static vix::http::Request make_req(std::string target)
+{
+  vix::http::Request::HeaderMap map;
+  map.emplace("Host", "localhost");
+
+  return vix::http::Request("GET", std::move(target), std::move(map), {});
+}
+
+static vix::cache::CacheEntry make_entry(std::int64_t created_at_ms)
+{
+  vix::cache::CacheEntry e;
+  e.status = 200;
+  e.body = "x";
+  e.created_at_ms = created_at_ms;
+  return e;
+}
+
+static void test_split_tags()
+{
+  auto tags = cache::split_tags(" user:1, posts  feed ");
+  assert(tags.size() == 3);
+  assert(tags[0] == "user:1");
+  assert(tags[1] == "posts");
+  assert(tags[2] == "feed");
+
+  assert(cache::split_tags("").empty());
+
+  std::cout << "[OK] tag_index: split_tags\n";
+}
+
+static void test_invalidate_tag_erases_keys_and_derived()
+{
+  auto store = std::make_shared<vix::cache::MemoryStore>();
+  cache::CacheTagIndex index(store);
+
+  const std::int64_t t0 = now_ms();
+  assert(index.record("k1", "/api/users/1", {"user:1", "users"}, t0));
+  assert(index.record("k2", "/api/users/2", {"user:2", "users"}, t0));
+  index.link("k1", "k1|ae=gzip");
+
+  store->put("k1", make_entry(t0));
+  store->put("k1|ae=gzip", make_entry(t0));
+  store->put("k2", make_entry(t0));
+
+  assert(index.invalidate_tag("user:1") == 1);
+  assert(!store->get("k1").has_value());
+  assert(!store->get("k1|ae=gzip").has_value());
+  assert(store->get("k2").has_value());
+
+  assert(index.is_invalidated("k1", t0));
+  assert(!index.is_invalidated("k2", t0));
+  assert(index.size() == 1);
+
+  assert(index.invalidate_tag("user:1") == 0);
+
+  std::cout << "[OK] tag_index: invalidate_tag erases keys and variants\n";
+}
+
+static void test_invalidate_prefix()
+{
+  cache::CacheTagIndex index;
+
+  const std::int64_t t0 = now_ms();
+  assert(index.record("a", "/api/users", {}, t0));
+  assert(index.record("b", "/api/users/7", {}, t0));
+  assert(index.record("c", "/api/posts", {}, t0));
+  assert(index.record("d", "/api/user", {}, t0));
+
+  assert(index.invalidate_prefix("/api/users") == 2);
+  assert(index.is_invalidated("a", t0));
+  assert(index.is_invalidated("b", t0));
+  assert(!index.is_invalidated("c", t0));
+  assert(!index.is_invalidated("d", t0));
+
+  std::cout << "[OK] tag_index: invalidate_prefix touches only matching paths\n";
+}
+
+static void test_stale_record_is_refused()
+{
+  cache::CacheTagIndex index;
+
+  const std::int64_t before = now_ms();
+  assert(index.record("k", "/api/x", {"x"}, before));
+  index.invalidate_tag("x");
+
+  // A response produced before the invalidation must not be stored.
+  assert(!index.record("k", "/api/x", {"x"}, before));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  const std::int64_t after = now_ms();
+  assert(index.record("k", "/api/x", {"x"}, after));
+  assert(!index.is_invalidated("k", after));
+
+  std::cout << "[OK] tag_index: records older than a tombstone are refused\n";
+}
+
+static void test_records_expire_and_counts()
+{
+  cache::CacheTagIndex index(nullptr, 60'000, 5);
+
+  const std::int64_t t0 = now_ms();
+  assert(!index.is_invalidated("k", t0)); // nothing invalidated yet
+
+  assert(index.record("k", "/api/k", {"t"}, t0));
+  assert(index.size() == 1);
+
+  // Unindexed keys are tombstoned but not counted.
+  assert(index.invalidate_key("never-stored") == 0);
+  assert(index.is_invalidated("never-stored", t0));
+  assert(!index.is_invalidated("k", t0));
+
+  // Records the store no longer holds age out on the next record.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  assert(index.record("other", "/api/o", {}, now_ms()));
+  assert(index.size() == 1);
+  assert(index.invalidate_tag("t") == 0);
+
+  // Entries created after the last invalidation skip the lookup.
+  const std::int64_t later = now_ms() + 1;
+  assert(!index.is_invalidated("k", later));
+
+  std::cout << "[OK] tag_index: records expire, only indexed keys are counted\n";
+}
+
+static void test_http_cache_tags_and_invalidation()
+{
+  auto store = std::make_shared<vix::cache::MemoryStore>();
+  vix::cache::CachePolicy policy;
+  policy.ttl_ms = 60'000;
+  auto c = std::make_shared<vix::cache::Cache>(policy, store);
+
+  auto index = std::make_shared<cache::CacheTagIndex>(store);
+
+  HttpCacheOptions opt{};
+  opt.tag_index = index;
+  auto mw = http_cache(c, opt);
+
+  int next_calls = 0;
+  auto run = [&](const std::string &target)
+  {
+    auto req = make_req(target);
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    mw(req, w, [&]()
+       {
+         next_calls++;
+         cache::add_cache_tags(req, {"users"});
+         w.header("Surrogate-Key", "user:1");
+         w.ok().text("v" + std::to_string(next_calls)); });
+
+    return res.body();
+  };
+
+  assert(run("/api/users/1") == "v1");
+  assert(run("/api/users/1") == "v1");
+  assert(next_calls == 1);
+  assert(index->size() == 1);
+
+  index->invalidate_tag("user:1");
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  assert(run("/api/users/1") == "v2");
+  assert(run("/api/users/1") == "v2");
+  assert(next_calls == 2);
+
+  index->invalidate_tag("users");
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  assert(run("/api/users/1") == "v3");
+  assert(next_calls == 3);
+
+  index->invalidate_prefix("/api/");
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  assert(run("/api/users/1") == "v4");
+  assert(next_calls == 4);
+
+  std::cout << "[OK] tag_index: http_cache records tags and honors invalidation\n";
+}
+
+int main()
+{
+  test_split_tags();
+  test_invalidate_tag_erases_keys_and_derived();
+  test_invalidate_prefix();
+  test_stale_record_is_refused();
+  test_records_expire_and_counts();
+  test_http_cache_tags_and_invalidation();
+
+  std::cout << "OK: tag_index smoke tests passed\n";
+  return 0;
+}
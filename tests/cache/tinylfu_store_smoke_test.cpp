@@ -0,0 +1,113 @@
+/**
+ *
+ *  @file tinylfu_store_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include <vix/cache/CacheEntry.hpp>
+#include <vix/middleware/cache/tinylfu_store.hpp>
+
+using namespace vix::middleware::cache;
+
+static vix::cache::CacheEntry make_entry(std::size_t body_size)
+{
+  vix::cache::CacheEntry e;
+  e.status = 200;
+  e.body = std::string(body_size, 'x');
+  return e;
+}
+
+static void test_byte_budget_is_enforced()
+{
+  TinyLfuOptions opt{};
+  opt.max_bytes = 4096;
+  TinyLfuStore store(opt);
+
+  for (int i = 0; i < 64; ++i)
+  {
+    const std::string key = "k" + std::to_string(i);
+    (void)store.get(key);
+    store.put(key, make_entry(500));
+  }
+
+  assert(store.bytes() <= opt.max_bytes);
+  assert(store.size() > 0);
+
+  std::cout << "[OK] tinylfu_store: byte budget enforced\n";
+}
+
+static void test_hot_entry_survives_scan()
+{
+  TinyLfuOptions opt{};
+  opt.max_bytes = 4096;
+  TinyLfuStore store(opt);
+
+  (void)store.get("hot");
+  store.put("hot", make_entry(1000));
+
+  for (int i = 0; i < 8; ++i)
+    assert(store.get("hot").has_value());
+
+  for (int i = 0; i < 200; ++i)
+  {
+    const std::string key = "scan" + std::to_string(i);
+    (void)store.get(key);
+    store.put(key, make_entry(1000));
+  }
+
+  assert(store.get("hot").has_value());
+  assert(store.stats().rejected > 0);
+
+  std::cout << "[OK] tinylfu_store: hot entry survives one-off scan\n";
+}
+
+static void test_oversized_entry_rejected()
+{
+  TinyLfuOptions opt{};
+  opt.max_bytes = 1024;
+  TinyLfuStore store(opt);
+
+  store.put("big", make_entry(4096));
+  assert(!store.get("big").has_value());
+  assert(store.bytes() == 0);
+
+  std::cout << "[OK] tinylfu_store: oversized entry rejected\n";
+}
+
+static void test_shared_entries_are_not_copied()
+{
+  TinyLfuStore store;
+
+  store.put_shared("k", make_shared_entry(make_entry(2048)));
+
+  SharedEntry a = store.get_shared("k");
+  SharedEntry b = store.get_shared("k");
+  assert(a && a == b);
+
+  store.put_shared("k", make_shared_entry(make_entry(16)));
+  assert(a->body.size() == 2048);
+  assert(store.get_shared("k")->body.size() == 16);
+
+  std::cout << "[OK] tinylfu_store: shared entries handed out by reference\n";
+}
+
+int main()
+{
+  test_byte_budget_is_enforced();
+  test_hot_entry_survives_scan();
+  test_oversized_entry_rejected();
+  test_shared_entries_are_not_copied();
+
+  std::cout << "OK: middleware tinylfu_store smoke tests passed\n";
+  return 0;
+}
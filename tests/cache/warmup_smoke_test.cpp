@@ -0,0 +1,158 @@
+/**
+ *
+ *  @file warmup_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <vix/http/Request.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/http/ResponseWrapper.hpp>
+#include <vix/middleware/app/http_cache.hpp>
+#include <vix/middleware/cache/warmup.hpp>
+#include <vix/middleware/observability/metrics.hpp>
+#include <vix/cache/Cache.hpp>
+#include <vix/cache/CachePolicy.hpp>
+#include <vix/cache/MemoryStore.hpp>
+
+using namespace vix::middleware;
+using vix::middleware::cache::parse_warmup_manifest;
+using vix::middleware::cache::warm_cache;
+using vix::middleware::cache::WarmupOptions;
+
+static void test_manifest_parsing()
+{
+  const auto t = parse_warmup_manifest(
+      "# hot endpoints\n"
+      "/api/products?page=1\r\n"
+      "\n"
+      "   /api/home  \n"
+      "api/not-a-target\n"
+      "/api/last");
+
+  assert(t.size() == 3);
+  assert(t[0] == "/api/products?page=1");
+  assert(t[1] == "/api/home");
+  assert(t[2] == "/api/last");
+
+  std::cout << "[OK] warmup: manifest parsing\n";
+}
+
+static void test_pool_replays_every_target()
+{
+  std::vector<std::string> targets;
+  for (int i = 0; i < 64; ++i)
+    targets.push_back("/api/items/" + std::to_string(i));
+
+  auto sink = std::make_shared<observability::InMemoryMetrics>();
+
+  WarmupOptions opt{};
+  opt.concurrency = 8;
+  opt.metrics = sink;
+
+  std::atomic<int> calls{0};
+  std::size_t last_done = 0;
+
+  opt.on_progress = [&](const cache::WarmupReport &r)
+  {
+    assert(r.done == last_done + 1);
+    last_done = r.done;
+  };
+
+  const auto report = warm_cache(
+      targets,
+      [&](const std::string &target)
+      {
+        calls.fetch_add(1);
+        if (target == "/api/items/3")
+          throw std::runtime_error("boom");
+        return target == "/api/items/7" ? 500 : 200;
+      },
+      opt);
+
+  assert(calls.load() == 64);
+  assert(report.total == 64);
+  assert(report.done == 64);
+  assert(report.ok == 62);
+  assert(report.failed == 2);
+  assert(last_done == 64);
+
+  assert(sink->counter("vix_http_cache_warmup_ok_total") == 62);
+  assert(sink->counter("vix_http_cache_warmup_failed_total") == 2);
+  assert(sink->gauge("vix_http_cache_warmup_targets") == 64.0);
+  assert(sink->gauge("vix_http_cache_warmup_progress_ratio") == 1.0);
+
+  // A throwing progress callback does not take a worker down.
+  opt.on_progress = [](const cache::WarmupReport &)
+  { throw std::runtime_error("progress"); };
+
+  const auto again = warm_cache(
+      targets, [](const std::string &)
+      { return 200; },
+      opt);
+  assert(again.done == 64 && again.ok == 64);
+
+  std::cout << "[OK] warmup: bounded pool replays every target\n";
+}
+
+static void test_warmup_fills_http_cache()
+{
+  vix::cache::CachePolicy policy;
+  policy.ttl_ms = 60'000;
+  auto c = std::make_shared<vix::cache::Cache>(policy, std::make_shared<vix::cache::MemoryStore>());
+
+  HttpCacheOptions opt{};
+  auto mw = http_cache(c, opt);
+
+  std::atomic<int> handler_calls{0};
+  auto handler = [&](vix::http::Request &req, vix::http::ResponseWrapper &res)
+  {
+    handler_calls.fetch_add(1);
+    res.status(200).text("body of " + req.path());
+  };
+
+  const auto report = warm_cache(
+      {"/api/a", "/api/b", "/api/c"},
+      app::make_warmup_fetch(mw, handler));
+
+  assert(report.ok == 3);
+  assert(handler_calls.load() == 3);
+
+  vix::http::Request::HeaderMap headers;
+  headers.emplace("Host", "localhost");
+  vix::http::Request req("GET", "/api/b", std::move(headers), std::string{});
+  vix::http::Response res;
+  vix::http::ResponseWrapper w(res);
+
+  mw(req, w, [&]()
+     { handler(req, w); });
+
+  assert(handler_calls.load() == 3);
+  assert(res.body() == "body of /api/b");
+  assert(res.header("x-vix-cache-status") == "hit");
+
+  std::cout << "[OK] warmup: replayed targets are served from cache\n";
+}
+
+int main()
+{
+  test_manifest_parsing();
+  test_pool_replays_every_target();
+  test_warmup_fills_http_cache();
+
+  std::cout << "OK: cache warmup smoke tests passed\n";
+  return 0;
+}
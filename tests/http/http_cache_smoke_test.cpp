@@ -11,9 +11,12 @@
  *  Vix.cpp
  */
 #include <cassert>
+#include <filesystem>
+#include <fstream>
 #include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -22,6 +25,9 @@
 #include <vix/http/Response.hpp>
 #include <vix/http/ResponseWrapper.hpp>
 #include <vix/middleware/http_cache.hpp>
+#include <vix/middleware/pipeline.hpp>
+#include <vix/middleware/performance/compression.hpp>
+#include <vix/middleware/performance/static_files.hpp>
 #include <vix/cache/Cache.hpp>
 #include <vix/cache/CacheContext.hpp>
 #include <vix/cache/CacheEntry.hpp>
@@ -167,11 +173,423 @@ static void test_bypass_header_skips_cache()
   std::cout << "[OK] http_cache: bypass header works\n";
 }
 
+static void test_encoded_variant_served_on_hit()
+{
+  std::shared_ptr<vix::cache::Cache> cache = make_cache();
+
+  HttpCacheOptions opt{};
+  opt.encoded_variants = true;
+  opt.variant_compression.min_size = 8;
+
+  auto mw = http_cache(cache, opt);
+  const std::string payload(256, 'x');
+
+  int next_calls = 0;
+
+  for (int i = 0; i < 2; ++i)
+  {
+    auto req = make_req("GET", "/api/big", {{"Accept-Encoding", "gzip, br"}});
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    mw(req, w, [&]()
+       {
+         next_calls++;
+         w.ok().text(payload); });
+
+    assert(res.status() == 200);
+
+    const std::string enc = res.header("Content-Encoding");
+    if (enc.empty())
+    {
+      assert(res.body() == payload);
+    }
+    else
+    {
+      assert(enc == "gzip" || enc == "br");
+      assert(res.body() != payload);
+      assert(!res.header("Vary").empty());
+    }
+  }
+
+  assert(next_calls == 1);
+
+  auto plain = make_req("GET", "/api/big");
+  vix::http::Response res;
+  vix::http::ResponseWrapper w(res);
+
+  mw(plain, w, [&]()
+     { next_calls++; });
+
+  assert(next_calls == 1);
+  assert(res.header("Content-Encoding").empty());
+  assert(res.body() == payload);
+
+  std::cout << "[OK] http_cache: encoded variant stored and replayed\n";
+}
+
+static void test_head_and_range_served_from_cache()
+{
+  std::shared_ptr<vix::cache::Cache> cache = make_cache();
+
+  HttpCacheOptions opt{};
+  auto mw = http_cache(cache, opt);
+
+  int next_calls = 0;
+  auto run = [&](const std::string &method,
+                 std::initializer_list<std::pair<std::string, std::string>> headers,
+                 vix::http::Response &res)
+  {
+    auto req = make_req(method, "/api/file", headers);
+    vix::http::ResponseWrapper w(res);
+
+    mw(req, w, [&]()
+       {
+         next_calls++;
+         w.ok().text("0123456789"); });
+  };
+
+  {
+    vix::http::Response res;
+    run("GET", {}, res);
+    assert(res.body() == "0123456789");
+  }
+
+  {
+    vix::http::Response res;
+    run("HEAD", {}, res);
+    assert(res.status() == 200);
+    assert(res.body().empty());
+    assert(res.header("Content-Length") == "10");
+    assert(res.header("x-vix-cache-status") == "hit");
+  }
+
+  {
+    vix::http::Response res;
+    run("GET", {{"Range", "bytes=2-5"}}, res);
+    assert(res.status() == 206);
+    assert(res.body() == "2345");
+    assert(res.header("Content-Range") == "bytes 2-5/10");
+  }
+
+  {
+    vix::http::Response res;
+    run("GET", {{"Range", "bytes=0-1, -2"}}, res);
+    assert(res.status() == 206);
+    assert(res.header("Content-Type").find("multipart/byteranges; boundary=") == 0);
+    assert(res.body().find("Content-Range: bytes 0-1/10\r\n\r\n01\r\n") != std::string::npos);
+    assert(res.body().find("Content-Range: bytes 8-9/10\r\n\r\n89\r\n") != std::string::npos);
+  }
+
+  {
+    vix::http::Response res;
+    run("GET", {{"Range", "bytes=50-"}}, res);
+    assert(res.status() == 416);
+    assert(res.header("Content-Range") == "bytes */10");
+  }
+
+  assert(next_calls == 1);
+
+  std::cout << "[OK] http_cache: HEAD and Range served from cache\n";
+}
+
+static void test_ranges_are_not_compressed()
+{
+  std::shared_ptr<vix::cache::Cache> cache = make_cache();
+
+  HttpPipeline p;
+  p.use(performance::compression({.min_size = 8}));
+  p.use(from_http_middleware(http_cache(cache)));
+
+  std::string body;
+  for (int i = 0; i < 200; ++i)
+    body += "line " + std::to_string(i % 10) + " of a text file\n";
+
+  auto run = [&](std::initializer_list<std::pair<std::string, std::string>> headers)
+  {
+    auto req = make_req("GET", "/files/report.txt", headers);
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    p.run(req, w, [&](Request &, Response &resp)
+          { resp.ok().header("Content-Type", "text/plain").text(body); });
+    return res;
+  };
+
+  run({});
+
+  auto res = run({{"Range", "bytes=10-109"}, {"Accept-Encoding", "gzip, br, zstd"}});
+  assert(res.header("x-vix-cache-status") == "hit");
+  assert(res.status() == 206);
+  assert(res.header("Content-Encoding").empty());
+  assert(res.body() == body.substr(10, 100));
+  assert(res.header("Content-Range") == "bytes 10-109/" + std::to_string(body.size()));
+
+  std::cout << "[OK] http_cache: ranged hits are not compressed\n";
+}
+
+static void test_precompressed_static_files()
+{
+  const auto root = std::filesystem::temp_directory_path() / "vix_cache_sidecars";
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root);
+
+  std::ofstream(root / "app.js", std::ios::binary) << "console.log('plain');";
+  std::ofstream(root / "app.js.br", std::ios::binary) << "BR-BYTES";
+
+  auto run = [&](HttpPipeline &p, std::initializer_list<std::pair<std::string, std::string>> headers)
+  {
+    auto req = make_req("GET", "/app.js", headers);
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    p.run(req, w, [&](Request &, Response &resp)
+          { resp.status(404).text("nope"); });
+    return res;
+  };
+
+  // Default key: the br sidecar is not stored for every client.
+  {
+    HttpPipeline p;
+    p.use(from_http_middleware(http_cache(make_cache())));
+    p.use(performance::static_files(root, {.mount = "/"}));
+
+    auto res = run(p, {{"Accept-Encoding", "br"}});
+    assert(res.header("Content-Encoding") == "br");
+
+    res = run(p, {});
+    assert(res.header("x-vix-cache-status") == "miss");
+    assert(res.header("Content-Encoding").empty());
+    assert(res.body() == "console.log('plain');");
+
+    res = run(p, {});
+    assert(res.header("x-vix-cache-status") == "hit");
+    assert(res.body() == "console.log('plain');");
+  }
+
+  // Keyed by Accept-Encoding: each coding gets its own entry.
+  {
+    HttpCacheOptions opt{};
+    opt.vary_headers = {"accept-encoding"};
+
+    HttpPipeline p;
+    p.use(from_http_middleware(http_cache(make_cache(), opt)));
+    p.use(performance::static_files(root, {.mount = "/"}));
+
+    run(p, {{"Accept-Encoding", "br"}});
+    run(p, {});
+
+    auto res = run(p, {{"Accept-Encoding", "br"}});
+    assert(res.header("x-vix-cache-status") == "hit");
+    assert(res.header("Content-Encoding") == "br");
+    assert(res.body() == "BR-BYTES");
+
+    res = run(p, {});
+    assert(res.header("x-vix-cache-status") == "hit");
+    assert(res.header("Content-Encoding").empty());
+    assert(res.body() == "console.log('plain');");
+  }
+
+  std::filesystem::remove_all(root);
+  std::cout << "[OK] http_cache: precompressed static files keyed by coding\n";
+}
+
+static void test_stale_if_error_serves_last_good_entry()
+{
+  auto store = std::make_shared<vix::cache::MemoryStore>();
+  vix::cache::CachePolicy policy;
+  policy.ttl_ms = 1'000;
+  policy.allow_stale_if_error = true;
+  policy.stale_if_error_ms = 60'000;
+  auto cache = std::make_shared<vix::cache::Cache>(policy, store);
+
+  HttpCacheOptions opt{};
+  opt.stale_if_error_ms = 60'000;
+  auto mw = http_cache(cache, opt);
+
+  auto req = make_req("GET", "/api/report");
+  const std::string key = compute_key_for(req, opt);
+
+  vix::cache::CacheEntry e;
+  e.status = 200;
+  e.body = "last good";
+  e.created_at_ms = now_ms() - 5'000;
+  cache->put(key, e);
+
+  {
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    mw(req, w, [&]()
+       { w.status(503).text("backend down"); });
+
+    assert(res.status() == 200);
+    assert(res.body() == "last good");
+    assert(res.header("x-vix-cache-status") == "stale-error");
+  }
+
+  {
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    mw(req, w, [&]()
+       { throw std::runtime_error("boom"); });
+
+    assert(res.status() == 200);
+    assert(res.body() == "last good");
+  }
+
+  {
+    auto other = make_req("GET", "/api/never-cached");
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    bool thrown = false;
+    try
+    {
+      mw(other, w, [&]()
+         { throw std::runtime_error("boom"); });
+    }
+    catch (const std::runtime_error &)
+    {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+
+  std::cout << "[OK] http_cache: stale-if-error serves last good entry\n";
+}
+
+static void test_negative_responses_use_their_own_cache()
+{
+  std::shared_ptr<vix::cache::Cache> cache = make_cache();
+  std::shared_ptr<vix::cache::Cache> negative = make_cache();
+
+  HttpCacheOptions opt{};
+  opt.negative_cache = negative;
+  auto mw = http_cache(cache, opt);
+
+  auto req = make_req("GET", "/api/items/404");
+  const std::string key = compute_key_for(req, opt);
+
+  int next_calls = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    mw(req, w, [&]()
+       {
+         next_calls++;
+         w.status(404).text("not found"); });
+
+    assert(res.status() == 404);
+    assert(res.body() == "not found");
+    if (i > 0)
+      assert(res.header("x-vix-cache-status") == "hit-negative");
+  }
+
+  assert(next_calls == 1);
+  assert(!cache->get(key, now_ms(), vix::cache::CacheContext::Online()).has_value());
+  assert(negative->get(key, now_ms(), vix::cache::CacheContext::Online()).has_value());
+
+  auto err = make_req("GET", "/api/items/500");
+  for (int i = 0; i < 2; ++i)
+  {
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    mw(err, w, [&]()
+       {
+         next_calls++;
+         w.status(500).text("error"); });
+  }
+
+  assert(next_calls == 3);
+
+  std::cout << "[OK] http_cache: negative responses cached separately\n";
+}
+
+static void test_compress_at_rest()
+{
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  std::shared_ptr<vix::cache::Cache> cache = make_cache();
+
+  HttpCacheOptions opt{};
+  opt.compress_at_rest = true;
+  opt.at_rest_min_size = 64;
+  auto mw = http_cache(cache, opt);
+
+  std::string payload;
+  for (int i = 0; i < 200; ++i)
+    payload += R"({"id":1,"name":"item","tags":["a","b"]})";
+
+  int next_calls = 0;
+  auto handler = [&](vix::http::ResponseWrapper &w)
+  {
+    next_calls++;
+    w.status(200).header("Content-Type", "application/json").text(payload);
+  };
+
+  auto plain = make_req("GET", "/api/big");
+  const std::string key = compute_key_for(plain, opt);
+
+  {
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    mw(plain, w, [&]()
+       { handler(w); });
+    assert(res.body() == payload);
+  }
+
+  auto stored = cache->get(key, now_ms(), vix::cache::CacheContext::Online());
+  assert(stored.has_value());
+  assert(stored->body.size() * 5 < payload.size());
+
+  {
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    mw(plain, w, [&]()
+       { handler(w); });
+
+    assert(res.header("x-vix-cache-status") == "hit");
+    assert(res.header("Content-Encoding").empty());
+    assert(res.header("x-vix-at-rest").empty());
+    assert(res.body() == payload);
+  }
+
+  {
+    auto gz = make_req("GET", "/api/big", {{"Accept-Encoding", "gzip, deflate"}});
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    mw(gz, w, [&]()
+       { handler(w); });
+
+    assert(res.header("x-vix-cache-status") == "hit");
+    assert(res.header("Content-Encoding") == "gzip");
+    assert(res.body() == stored->body);
+
+    std::string inflated;
+    assert(performance::decompress_with("gzip", res.body(), inflated));
+    assert(inflated == payload);
+  }
+
+  assert(next_calls == 1);
+#endif
+
+  std::cout << "[OK] http_cache: bodies compressed at rest\n";
+}
+
 int main()
 {
   test_cache_hit_serves_response();
   test_cache_miss_then_put_on_200();
   test_bypass_header_skips_cache();
+  test_encoded_variant_served_on_hit();
+  test_head_and_range_served_from_cache();
+  test_ranges_are_not_compressed();
+  test_precompressed_static_files();
+  test_stale_if_error_serves_last_good_entry();
+  test_negative_responses_use_their_own_cache();
+  test_compress_at_rest();
 
   std::cout << "OK: middleware http_cache smoke tests passed\n";
   return 0;
@@ -0,0 +1,107 @@
+/**
+ *
+ *  @file range_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include <vix/middleware/http/range.hpp>
+
+using namespace vix::middleware::range;
+
+static void test_single_ranges()
+{
+  auto r = parse_range("bytes=0-4", 10);
+  assert(r.status == RangeStatus::Satisfiable);
+  assert(r.ranges.size() == 1);
+  assert(r.ranges[0].first == 0 && r.ranges[0].last == 4);
+
+  r = parse_range("bytes=7-", 10);
+  assert(r.ranges[0].first == 7 && r.ranges[0].last == 9);
+
+  r = parse_range("bytes=-3", 10);
+  assert(r.ranges[0].first == 7 && r.ranges[0].last == 9);
+
+  r = parse_range("bytes=-30", 10);
+  assert(r.ranges[0].first == 0 && r.ranges[0].last == 9);
+
+  r = parse_range("Bytes = 5-99999999999999999999999", 10);
+  assert(r.status == RangeStatus::Satisfiable);
+  assert(r.ranges[0].first == 5 && r.ranges[0].last == 9);
+
+  std::cout << "[OK] range: single ranges\n";
+}
+
+static void test_multi_ranges_are_coalesced()
+{
+  auto r = parse_range("bytes=6-8, 0-1, 1-3, 20-30", 10);
+  assert(r.status == RangeStatus::Satisfiable);
+  assert(r.ranges.size() == 2);
+  assert(r.ranges[0].first == 0 && r.ranges[0].last == 3);
+  assert(r.ranges[1].first == 6 && r.ranges[1].last == 8);
+
+  std::cout << "[OK] range: multi ranges sorted and coalesced\n";
+}
+
+static void test_invalid_and_unsatisfiable()
+{
+  assert(parse_range("", 10).status == RangeStatus::Ignore);
+  assert(parse_range("items=0-1", 10).status == RangeStatus::Ignore);
+  assert(parse_range("bytes=5-2", 10).status == RangeStatus::Ignore);
+  assert(parse_range("bytes=a-b", 10).status == RangeStatus::Ignore);
+  assert(parse_range("bytes=0-0,1-1,2-2", 10, 2).status == RangeStatus::Ignore);
+
+  assert(parse_range("bytes=10-", 10).status == RangeStatus::Unsatisfiable);
+  assert(parse_range("bytes=-0", 10).status == RangeStatus::Unsatisfiable);
+  assert(parse_range("bytes=0-", 0).status == RangeStatus::Unsatisfiable);
+
+  std::cout << "[OK] range: invalid headers ignored, unsatisfiable detected\n";
+}
+
+static void test_if_range()
+{
+  assert(if_range_matches("", "\"a\"", ""));
+  assert(if_range_matches("\"a\"", "\"a\"", ""));
+  assert(!if_range_matches("\"b\"", "\"a\"", ""));
+  assert(!if_range_matches("W/\"a\"", "W/\"a\"", ""));
+  assert(if_range_matches("Tue, 01 Jan 2030 00:00:00 GMT", "", "Tue, 01 Jan 2030 00:00:00 GMT"));
+  assert(!if_range_matches("Tue, 01 Jan 2030 00:00:00 GMT", "\"a\"", ""));
+
+  std::cout << "[OK] range: If-Range validators\n";
+}
+
+static void test_multipart_body()
+{
+  const std::string body = "0123456789";
+  auto r = parse_range("bytes=0-1,8-", body.size());
+  const std::string out = multipart_byteranges(body, r.ranges, "text/plain", "B");
+
+  const std::string expected =
+      "--B\r\nContent-Type: text/plain\r\nContent-Range: bytes 0-1/10\r\n\r\n01\r\n"
+      "--B\r\nContent-Type: text/plain\r\nContent-Range: bytes 8-9/10\r\n\r\n89\r\n"
+      "--B--\r\n";
+  assert(out == expected);
+
+  std::cout << "[OK] range: multipart/byteranges body\n";
+}
+
+int main()
+{
+  test_single_ranges();
+  test_multi_ranges_are_coalesced();
+  test_invalid_and_unsatisfiable();
+  test_if_range();
+  test_multipart_body();
+
+  std::cout << "OK: range smoke tests passed\n";
+  return 0;
+}
@@ -0,0 +1,451 @@
+/**
+ *
+ *  @file body_stream_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <vix/http/Request.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/http/ResponseWrapper.hpp>
+#include <vix/middleware/http_cache.hpp>
+#include <vix/middleware/pipeline.hpp>
+#include <vix/middleware/performance/body_stream.hpp>
+#include <vix/middleware/performance/compression.hpp>
+#include <vix/middleware/performance/etag.hpp>
+#include <vix/cache/Cache.hpp>
+#include <vix/cache/CacheContext.hpp>
+#include <vix/cache/CachePolicy.hpp>
+#include <vix/cache/MemoryStore.hpp>
+
+using namespace vix::middleware;
+
+static vix::http::Request make_req(
+    std::initializer_list<std::pair<std::string, std::string>> headers = {},
+    std::string method = "GET")
+{
+  vix::http::Request::HeaderMap map;
+  map.emplace("Host", "localhost");
+
+  for (const auto &kv : headers)
+    map.emplace(kv.first, kv.second);
+
+  return vix::http::Request(std::move(method), "/export", std::move(map), "");
+}
+
+static std::string row(int i)
+{
+  return "{\"id\":" + std::to_string(i) + ",\"name\":\"item-" + std::to_string(i % 17) +
+         "\",\"tags\":[\"alpha\",\"beta\"],\"price\":" + std::to_string(i % 100) + "}\n";
+}
+
+// Writes rows in 40 chunks; returns the identity body.
+static std::string stream_rows(Request &req, Response &res)
+{
+  res.ok().header("Content-Type", "application/x-ndjson+json");
+
+  auto *out = performance::body_stream(req);
+  assert(out);
+
+  std::string all;
+  for (int c = 0; c < 40; ++c)
+  {
+    std::string chunk;
+    for (int i = 0; i < 50; ++i)
+      chunk += row(c * 50 + i);
+
+    all += chunk;
+    assert(out->write(chunk));
+  }
+  return all;
+}
+
+static std::string expected_etag(const std::string &body)
+{
+  return "W/\"" + performance::to_hex_u64(performance::fnv1a_64(body)) + "\"";
+}
+
+// Decodes chunked transfer coding; trailers go to @p trailers.
+static bool dechunk(const std::string &wire, std::string &body, std::string &trailers,
+                    std::vector<std::size_t> *sizes = nullptr)
+{
+  std::size_t pos = 0;
+  body.clear();
+
+  for (;;)
+  {
+    const std::size_t eol = wire.find("\r\n", pos);
+    if (eol == std::string::npos)
+      return false;
+
+    const std::size_t n = std::stoul(wire.substr(pos, eol - pos), nullptr, 16);
+    pos = eol + 2;
+
+    if (n == 0)
+    {
+      trailers = wire.substr(pos);
+      return trailers.size() >= 2 && trailers.compare(trailers.size() - 2, 2, "\r\n") == 0;
+    }
+
+    if (sizes)
+      sizes->push_back(n);
+
+    body.append(wire, pos, n);
+    pos += n;
+    if (wire.compare(pos, 2, "\r\n") != 0)
+      return false;
+    pos += 2;
+  }
+}
+
+static void test_buffered_fallback()
+{
+  HttpPipeline p;
+  p.use(performance::streaming());
+
+  std::string identity;
+  auto req = make_req({{"Accept-Encoding", "gzip"}});
+  vix::http::Response res;
+  vix::http::ResponseWrapper w(res);
+
+  p.run(req, w, [&](Request &rq, Response &rs)
+        { identity = stream_rows(rq, rs); });
+
+  assert(res.status() == 200);
+  assert(res.header("ETag") == expected_etag(identity));
+  assert(res.header("Transfer-Encoding").empty());
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  assert(res.header("Content-Encoding") == "gzip");
+  assert(!res.header("Vary").empty());
+
+  std::string back;
+  assert(performance::gzip_decompress(res.body(), back));
+  assert(back == identity);
+  assert(res.body().size() < identity.size());
+#else
+  assert(res.body() == identity);
+#endif
+
+  // Same body, matching If-None-Match.
+  auto again = make_req({{"Accept-Encoding", "gzip"}, {"If-None-Match", expected_etag(identity)}});
+  vix::http::Response res2;
+  vix::http::ResponseWrapper w2(res2);
+  p.run(again, w2, [&](Request &rq, Response &rs)
+        { stream_rows(rq, rs); });
+
+  assert(res2.status() == 304);
+  assert(res2.body().empty());
+
+  // Errors are not tagged and never become 304.
+  auto missing = make_req({{"If-None-Match", expected_etag("gone")}});
+  vix::http::Response res3;
+  vix::http::ResponseWrapper w3(res3);
+  p.run(missing, w3, [&](Request &rq, Response &rs)
+        {
+          rs.status(404).header("Content-Type", "text/plain");
+          performance::body_stream(rq)->write("gone"); });
+
+  assert(res3.status() == 404);
+  assert(res3.body() == "gone");
+  assert(res3.header("ETag").empty());
+
+  std::cout << "[OK] body stream buffered fallback\n";
+}
+
+static void test_chunked_transport()
+{
+  std::string wire;
+  bool headers_sent = false;
+
+  performance::StreamingOptions opt;
+  opt.chunk_size = 4096;
+  opt.transport = [&](Context &)
+  {
+    performance::BodyTransport t;
+    t.begin = [&](vix::http::Response &r)
+    {
+      assert(r.header("Transfer-Encoding") == "chunked");
+      assert(r.header("Trailer") == "ETag");
+      headers_sent = true;
+      return true;
+    };
+    t.write = [&](std::string_view bytes)
+    {
+      assert(headers_sent);
+      wire.append(bytes.data(), bytes.size());
+      return true;
+    };
+    return t;
+  };
+
+  HttpPipeline p;
+  p.use(performance::compression({.min_size = 8}));
+  p.use(performance::etag());
+  p.use(performance::streaming(opt));
+
+  auto run = [&](std::string accept, std::string &identity)
+  {
+    wire.clear();
+    headers_sent = false;
+
+    auto req = make_req({{"Accept-Encoding", std::move(accept)}});
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    p.run(req, w, [&](Request &rq, Response &rs)
+          {
+            rs.ok().header("Content-Type", "text/plain");
+            auto *out = performance::body_stream(rq);
+
+            // Headers and the first bytes leave before the handler is done.
+            assert(out->write(row(0)));
+            assert(out->flush());
+            assert(headers_sent && !wire.empty());
+
+            identity = row(0);
+            for (int i = 1; i < 2000; ++i)
+            {
+              identity += row(i);
+              assert(out->write(row(i)));
+            } });
+
+    return res;
+  };
+
+  std::string identity;
+
+  // Identity.
+  auto res = run("identity", identity);
+  assert(res.body().empty());
+  assert(res.header("Content-Encoding").empty());
+  assert(res.header("ETag").empty());
+
+  std::string body, trailers;
+  std::vector<std::size_t> sizes;
+  assert(dechunk(wire, body, trailers, &sizes));
+  assert(body == identity);
+  assert(trailers == "ETag: " + expected_etag(identity) + "\r\n\r\n");
+
+  {
+    wire.clear();
+    headers_sent = false;
+
+    auto req = make_req();
+    vix::http::Response err;
+    vix::http::ResponseWrapper w(err);
+    HttpPipeline q;
+    performance::StreamingOptions no_tag = opt;
+    no_tag.transport = [&](Context &)
+    {
+      performance::BodyTransport t;
+      t.begin = [&](vix::http::Response &r)
+      {
+        assert(r.header("Trailer").empty());
+        headers_sent = true;
+        return true;
+      };
+      t.write = [&](std::string_view bytes)
+      {
+        wire.append(bytes.data(), bytes.size());
+        return true;
+      };
+      return t;
+    };
+    q.use(performance::streaming(no_tag));
+    q.run(req, w, [&](Request &rq, Response &rs)
+          {
+            rs.status(500).header("Content-Type", "text/plain");
+            performance::body_stream(rq)->write("failure"); });
+
+    assert(headers_sent);
+    assert(dechunk(wire, body, trailers));
+    assert(body == "failure" && trailers == "\r\n");
+  }
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  res = run("gzip", identity);
+  assert(res.header("Content-Encoding") == "gzip");
+  assert(res.body().empty());
+
+  sizes.clear();
+  assert(dechunk(wire, body, trailers, &sizes));
+  for (std::size_t n : sizes)
+    assert(n <= opt.chunk_size);
+
+  std::string back;
+  assert(performance::gzip_decompress(body, back));
+  assert(back == identity);
+#endif
+
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+  res = run("zstd", identity);
+  assert(res.header("Content-Encoding") == "zstd");
+  assert(dechunk(wire, body, trailers));
+
+  std::string unz;
+  assert(performance::zstd_decompress(body, unz));
+  assert(unz == identity);
+#endif
+
+#if defined(VIX_HAS_BROTLI) && VIX_HAS_BROTLI
+  res = run("br", identity);
+  assert(res.header("Content-Encoding") == "br");
+  assert(dechunk(wire, body, trailers));
+  assert(!body.empty() && body.size() < identity.size());
+#endif
+
+  std::cout << "[OK] body stream chunked transport\n";
+}
+
+static void test_untouched_and_skipped()
+{
+  HttpPipeline p;
+  p.use(performance::streaming());
+
+  // Handlers that do not stream keep the buffered path.
+  auto req = make_req({{"Accept-Encoding", "gzip"}});
+  vix::http::Response res;
+  vix::http::ResponseWrapper w(res);
+  p.run(req, w, [&](Request &rq, Response &rs)
+        {
+          assert(!performance::body_stream(rq)->started());
+          rs.ok().text("plain"); });
+
+  assert(res.body() == "plain");
+  assert(res.header("ETag").empty());
+  assert(!vix::middleware::utils::body_streamed(req));
+
+  // Already-compressed media types are streamed as is.
+  auto img = make_req({{"Accept-Encoding", "gzip, br, zstd"}});
+  vix::http::Response res2;
+  vix::http::ResponseWrapper w2(res2);
+  p.run(img, w2, [&](Request &rq, Response &rs)
+        {
+          rs.ok().header("Content-Type", "image/png");
+          performance::body_stream(rq)->write("PNG-BYTES"); });
+
+  assert(res2.header("Content-Encoding").empty());
+  assert(res2.body() == "PNG-BYTES");
+
+  std::cout << "[OK] body stream leaves other responses alone\n";
+}
+
+static void test_cache_tee()
+{
+  auto store = std::make_shared<vix::cache::MemoryStore>();
+  vix::cache::CachePolicy policy;
+  policy.ttl_ms = 60'000;
+  auto cache = std::make_shared<vix::cache::Cache>(policy, store);
+
+  performance::StreamingOptions opt;
+  opt.tee_max_bytes = 1024 * 1024;
+
+  HttpPipeline p;
+  p.use(from_http_middleware(http_cache(cache)));
+  p.use(performance::streaming(opt));
+
+  int calls = 0;
+  std::string identity;
+
+  auto run = [&](std::string accept)
+  {
+    auto req = make_req({{"Accept-Encoding", std::move(accept)}});
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    p.run(req, w, [&](Request &rq, Response &rs)
+          {
+            ++calls;
+            identity = stream_rows(rq, rs); });
+    return res;
+  };
+
+  auto res = run("gzip");
+  assert(calls == 1);
+  assert(res.header("x-vix-cache-status") == "miss");
+
+  // Served from the cache, identity body and the stream's ETag.
+  res = run("");
+  assert(calls == 1);
+  assert(res.body() == identity);
+  assert(res.header("ETag") == expected_etag(identity));
+  assert(res.header("Content-Encoding").empty());
+
+  // Bodies larger than the tee are not cached.
+  opt.tee_max_bytes = 1024;
+  auto small_cache = std::make_shared<vix::cache::Cache>(policy, std::make_shared<vix::cache::MemoryStore>());
+  HttpPipeline q;
+  q.use(from_http_middleware(http_cache(small_cache)));
+  q.use(performance::streaming(opt));
+
+  for (int i = 0; i < 2; ++i)
+  {
+    auto req = make_req();
+    vix::http::Response r;
+    vix::http::ResponseWrapper w(r);
+    q.run(req, w, [&](Request &rq, Response &rs)
+          {
+            ++calls;
+            stream_rows(rq, rs); });
+  }
+  assert(calls == 3);
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  // A coding set by the handler passes through and stays on the entry,
+  // keyed by Accept-Encoding.
+  opt.tee_max_bytes = 1024 * 1024;
+  auto enc_cache = std::make_shared<vix::cache::Cache>(policy, std::make_shared<vix::cache::MemoryStore>());
+  HttpCacheOptions enc_opt{};
+  enc_opt.vary_headers = {"accept-encoding"};
+  HttpPipeline e;
+  e.use(from_http_middleware(http_cache(enc_cache, enc_opt)));
+  e.use(performance::streaming(opt));
+
+  std::string packed;
+  assert(performance::gzip_compress(row(1) + row(2), packed, 6));
+
+  for (int i = 0; i < 2; ++i)
+  {
+    auto req = make_req({{"Accept-Encoding", "gzip"}});
+    vix::http::Response r;
+    vix::http::ResponseWrapper w(r);
+    e.run(req, w, [&](Request &rq, Response &rs)
+          {
+            ++calls;
+            rs.ok().header("Content-Type", "text/plain").header("Content-Encoding", "gzip");
+            performance::body_stream(rq)->write(packed); });
+
+    assert(r.header("Content-Encoding") == "gzip");
+    assert(r.body() == packed);
+  }
+  assert(calls == 4);
+#endif
+
+  std::cout << "[OK] body stream cache tee\n";
+}
+
+int main()
+{
+  test_buffered_fallback();
+  test_chunked_transport();
+  test_untouched_and_skipped();
+  test_cache_tee();
+
+  std::cout << "OK: body stream smoke tests passed\n";
+  return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ *
+ *  @file compression_dictionary_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vix/http/Request.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/http/ResponseWrapper.hpp>
+#include <vix/middleware/pipeline.hpp>
+#include <vix/middleware/performance/compression.hpp>
+#include <vix/middleware/performance/compression_dictionary.hpp>
+
+using namespace vix::middleware;
+
+static void test_helpers()
+{
+  assert(performance::base64_encode("") == "");
+  assert(performance::base64_encode("f") == "Zg==");
+  assert(performance::base64_encode("fo") == "Zm8=");
+  assert(performance::base64_encode("foo") == "Zm9v");
+
+  assert(performance::base64_encode(performance::sha256_raw("abc")) ==
+         "ungWv48Bz+pBQUDeXa4iI7ADYaOWF3qctBD/YfIAFa0=");
+
+  assert(performance::dictionary_matches("/api/users/1", "/api/*"));
+  assert(!performance::dictionary_matches("/static/app.js", "/api/*"));
+  assert(performance::dictionary_matches("/feed", "/feed"));
+
+  std::cout << "[OK] dictionary helpers\n";
+}
+
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+static vix::http::Request make_req(
+    std::string target,
+    std::initializer_list<std::pair<std::string, std::string>> headers = {})
+{
+  vix::http::Request::HeaderMap map;
+  map.emplace("Host", "localhost");
+
+  for (const auto &kv : headers)
+    map.emplace(kv.first, kv.second);
+
+  return vix::http::Request("GET", std::move(target), std::move(map), "");
+}
+
+static std::string api_body(int i)
+{
+  return R"({"id":)" + std::to_string(i) +
+         R"(,"type":"order","status":")" + (i % 3 ? "shipped" : "pending") +
+         R"(","customer":{"id":)" + std::to_string(i * 7 % 1000) +
+         R"(,"country":"FR","tier":"gold"},"items":[{"sku":"SKU-)" + std::to_string(i % 50) +
+         R"(","quantity":)" + std::to_string(i % 4 + 1) +
+         R"(,"currency":"EUR"}],"created_at":"2025-01-)" + std::to_string(i % 28 + 10) + R"(T10:00:00Z"})";
+}
+
+static void test_train_and_roundtrip()
+{
+  std::vector<std::string> samples;
+  for (int i = 0; i < 500; ++i)
+    samples.push_back(api_body(i));
+
+  std::string bytes;
+  assert(!performance::train_dictionary({"a", "b"}, bytes));
+  assert(performance::train_dictionary(samples, bytes, 4096));
+  assert(!bytes.empty() && bytes.size() <= 4096);
+
+  auto dict = performance::CompressionDictionary::load(bytes);
+  assert(dict);
+  assert(dict->id().front() == ':' && dict->id().back() == ':');
+
+  const std::string body = api_body(1234);
+
+  std::string packed;
+  assert(dict->compress(body, packed));
+
+  std::string plain_zstd;
+  assert(performance::zstd_compress(body, plain_zstd, 3));
+  assert(packed.size() < plain_zstd.size());
+
+  std::string back;
+  assert(dict->decompress(packed, back));
+  assert(back == body);
+
+  // Regular zstd decoders skip the header frame and only need the dictionary.
+  std::string via_zstd(body.size(), '\0');
+  ZSTD_DCtx *dctx = ZSTD_createDCtx();
+  const std::size_t n = ZSTD_decompress_usingDict(
+      dctx, via_zstd.data(), via_zstd.size(),
+      packed.data(), packed.size(), bytes.data(), bytes.size());
+  ZSTD_freeDCtx(dctx);
+  assert(!ZSTD_isError(n) && via_zstd == body);
+
+  auto other = performance::CompressionDictionary::load("not a trained dictionary but still raw content");
+  assert(other);
+  assert(!other->decompress(packed, back));
+
+  std::cout << "[OK] dictionary training and dcz roundtrip\n";
+}
+
+static void test_middleware()
+{
+  std::vector<std::string> samples;
+  for (int i = 0; i < 500; ++i)
+    samples.push_back(api_body(i));
+
+  std::string bytes;
+  assert(performance::train_dictionary(samples, bytes, 4096));
+  std::shared_ptr<const performance::CompressionDictionary> dict =
+      performance::CompressionDictionary::load(bytes);
+
+  HttpPipeline p;
+  p.use(performance::compression({.min_size = 8}));
+  p.use(performance::dictionary_compression(dict));
+
+  auto run = [&](vix::http::Request req)
+  {
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    p.run(req, w, [&](Request &, Response &resp)
+          { resp.ok().header("Content-Type", "application/json").text(api_body(42)); });
+    return res;
+  };
+
+  // The dictionary endpoint.
+  auto res = run(make_req("/_vix/dictionary/api.dict"));
+  assert(res.status() == 200);
+  assert(res.body() == bytes);
+  assert(res.header("Use-As-Dictionary") == "match=\"/api/*\"");
+
+  // Client with the dictionary.
+  res = run(make_req("/api/orders/42", {{"Accept-Encoding", "gzip, br, zstd, dcz"}, {"Available-Dictionary", dict->id()}}));
+  assert(res.header("Content-Encoding") == "dcz");
+  assert(res.header("Vary").find("Available-Dictionary") != std::string::npos);
+
+  std::string back;
+  assert(dict->decompress(res.body(), back));
+  assert(back == api_body(42));
+
+  // Client without it: advertised, regular compression path.
+  res = run(make_req("/api/orders/42", {{"Accept-Encoding", "gzip, dcz"}}));
+  assert(res.header("Content-Encoding") != "dcz");
+  assert(res.header("Link").find("compression-dictionary") != std::string::npos);
+
+  // Stale dictionary id.
+  res = run(make_req("/api/orders/42", {{"Accept-Encoding", "dcz"}, {"Available-Dictionary", ":AAAA:"}}));
+  assert(res.header("Content-Encoding") != "dcz");
+
+  // Outside the match pattern.
+  res = run(make_req("/other", {{"Accept-Encoding", "dcz"}, {"Available-Dictionary", dict->id()}}));
+  assert(res.header("Content-Encoding") != "dcz");
+  assert(res.header("Link").empty());
+
+  std::cout << "[OK] dictionary_compression middleware\n";
+}
+#endif
+
+int main()
+{
+  test_helpers();
+
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+  test_train_and_roundtrip();
+  test_middleware();
+#endif
+
+  std::cout << "OK: compression dictionary smoke tests passed\n";
+  return 0;
+}
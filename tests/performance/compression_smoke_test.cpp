@@ -11,14 +11,20 @@
  *  Vix.cpp
  */
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <vix/http/Request.hpp>
 #include <vix/http/Response.hpp>
 #include <vix/http/ResponseWrapper.hpp>
+#include <vix/middleware/observability/metrics.hpp>
 #include <vix/middleware/pipeline.hpp>
 #include <vix/middleware/performance/compression.hpp>
 
@@ -37,8 +43,428 @@ static vix::http::Request make_req(
   return vix::http::Request("GET", std::move(target), std::move(map), "");
 }
 
+static void test_codecs_reuse_thread_contexts()
+{
+  std::string json;
+  for (int i = 0; i < 300; ++i)
+    json += R"({"id":)" + std::to_string(i) + R"(,"name":"item","ok":true},)";
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  for (int level : {1, 6, 1, 9, 6})
+  {
+    std::string gz;
+    assert(performance::gzip_compress(json, gz, level));
+    assert(gz.size() < json.size());
+
+    std::string back;
+    assert(performance::gzip_decompress(gz, back));
+    assert(back == json);
+
+    // The thread's single stream switched levels: same bytes as a fresh one.
+    std::string fresh;
+    std::thread([&]()
+                { assert(performance::gzip_compress(json, fresh, level)); })
+        .join();
+    assert(gz == fresh);
+  }
+
+  std::string empty_gz;
+  assert(performance::gzip_compress(std::string{}, empty_gz, 6));
+#endif
+
+#if defined(VIX_HAS_BROTLI) && VIX_HAS_BROTLI
+  std::string first;
+  assert(performance::brotli_compress(json, first, 5));
+  assert(!first.empty() && first.size() < json.size());
+
+  for (int i = 0; i < 4; ++i)
+  {
+    std::string again;
+    assert(performance::brotli_compress(json, again, 5));
+    assert(again == first);
+  }
+
+  std::string small;
+  assert(performance::brotli_compress("a", small, 11));
+  assert(!small.empty());
+#endif
+
+  (void)json;
+  std::cout << "[OK] compression codecs reuse thread contexts\n";
+}
+
+static void test_accept_encoding_qvalues()
+{
+  const auto list = performance::parse_accept_encoding("GZIP;q=0.5, br ; Q=1.0, zstd;q=0, x-bad;q=2, *;q=0.1");
+  assert(list.size() == 4);
+  assert(list[0].coding == "gzip" && list[0].q == 0.5);
+  assert(list[1].coding == "br" && list[1].q == 1.0);
+  assert(performance::accepted_q(list, "zstd") == 0.0);
+  assert(performance::accepted_q(list, "deflate") == 0.1);
+
+  assert(performance::token_allowed("gzip, br", "gzip"));
+  assert(!performance::token_allowed("gzip;q=0, br", "gzip"));
+  assert(!performance::token_allowed("gzip;q=0.000", "gzip"));
+  assert(performance::token_allowed("*", "gzip"));
+  assert(!performance::token_allowed("br", "gzip"));
+  assert(performance::token_allowed("x-gzip", "gzip"));
+
+  performance::CompressionOptions opt{};
+
+  // No header, or nothing acceptable: no coding.
+  assert(performance::negotiate_encoding("", opt).empty());
+  assert(performance::negotiate_encoding("identity", opt).empty());
+  assert(performance::negotiate_encoding("*;q=0", opt).empty());
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  // The client's weights win over server preference.
+  assert(performance::negotiate_encoding("br;q=0.2, zstd;q=0.1, gzip;q=0.9", opt) == "gzip");
+  assert(performance::negotiate_encoding("gzip;q=0.4, identity;q=0.8", opt).empty());
+#endif
+
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+  // Ties go to the cheapest coding.
+  assert(performance::negotiate_encoding("gzip, br, zstd", opt) == "zstd");
+  assert(performance::negotiate_encoding("*", opt) == "zstd");
+  opt.prefer_zstd = false;
+#endif
+
+#if defined(VIX_HAS_BROTLI) && VIX_HAS_BROTLI
+  assert(performance::negotiate_encoding("gzip, br, zstd", opt) == "br");
+  opt.prefer_br = false;
+#endif
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  assert(performance::negotiate_encoding("gzip, br, zstd", opt) == "gzip");
+#endif
+
+  std::cout << "[OK] compression accept-encoding q-values\n";
+}
+
+static void test_zstd_roundtrip()
+{
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+  std::string json;
+  for (int i = 0; i < 300; ++i)
+    json += R"({"id":)" + std::to_string(i) + R"(,"name":"item","ok":true},)";
+
+  performance::CompressionOptions opt{};
+  for (int i = 0; i < 3; ++i)
+  {
+    std::string z;
+    assert(performance::compress_with("zstd", json, z, opt));
+    assert(z.size() < json.size());
+
+    std::string back;
+    assert(performance::decompress_with("zstd", z, back));
+    assert(back == json);
+
+    std::string truncated;
+    assert(!performance::zstd_decompress(z.substr(0, z.size() / 2), truncated));
+  }
+
+  HttpPipeline p;
+  p.use(performance::compression({.min_size = 8}));
+
+  auto req = make_req("/z", {{"Accept-Encoding", "gzip;q=0.8, zstd"}});
+  vix::http::Response res;
+  vix::http::ResponseWrapper w(res);
+
+  p.run(req, w, [&](Request &, Response &resp)
+        { resp.ok().text(json); });
+
+  assert(res.header("Content-Encoding") == "zstd");
+
+  std::string back;
+  assert(performance::zstd_decompress(res.body(), back));
+  assert(back == json);
+#endif
+
+  std::cout << "[OK] compression zstd roundtrip\n";
+}
+
+static void test_content_type_policy()
+{
+  performance::CompressionOptions opt{};
+
+  assert(performance::is_compressible_type("text/html; charset=utf-8", opt));
+  assert(performance::is_compressible_type("Application/JSON", opt));
+  assert(performance::is_compressible_type("application/problem+json", opt));
+  assert(performance::is_compressible_type("image/svg+xml", opt));
+  assert(performance::is_compressible_type("", opt));
+  assert(!performance::is_compressible_type("image/png", opt));
+  assert(!performance::is_compressible_type("font/woff2", opt));
+  assert(!performance::is_compressible_type("video/mp4", opt));
+  assert(!performance::is_compressible_type("application/octet-stream", opt));
+
+  opt.compress_types.clear();
+  assert(performance::is_compressible_type("application/octet-stream", opt));
+  assert(!performance::is_compressible_type("application/zip", opt));
+
+  std::string text;
+  for (int i = 0; i < 200; ++i)
+    text += "hello world, ";
+
+  std::string noise;
+  std::uint32_t x = 2463534242u;
+  for (int i = 0; i < 8192; ++i)
+  {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    noise.push_back(static_cast<char>(x & 0xff));
+  }
+
+  assert(performance::estimate_compression_gain(text, 4096) > 0.4);
+  assert(performance::estimate_compression_gain(noise, 4096) < 0.05);
+
+  opt.sample_bytes = 4096;
+  assert(performance::worth_compressing("text/plain", text, opt));
+  assert(!performance::worth_compressing("application/octet-stream", noise, opt));
+
+  HttpPipeline p;
+  p.use(performance::compression({.min_size = 8}));
+
+  auto req = make_req("/logo.png", {{"Accept-Encoding", "gzip, br, zstd"}});
+  vix::http::Response res;
+  vix::http::ResponseWrapper w(res);
+
+  p.run(req, w, [&](Request &, Response &resp)
+        { resp.ok().header("Content-Type", "image/png").text(text); });
+
+  assert(res.header("Content-Encoding").empty());
+  assert(res.body() == text);
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  assert(res.header("X-Vix-Compression-Choice") == "skipped");
+#endif
+
+  std::cout << "[OK] compression content-type policy and sampling\n";
+}
+
+namespace
+{
+  class ThreadExecutor final : public vix::executor::IExecutor
+  {
+  public:
+    ~ThreadExecutor() override
+    {
+      for (auto &t : threads_)
+        t.join();
+    }
+
+    bool post(std::function<void()> fn, vix::executor::TaskOptions = {}) override
+    {
+      threads_.emplace_back(std::move(fn));
+      return true;
+    }
+
+  private:
+    std::vector<std::thread> threads_;
+  };
+}
+
+static void test_parallel_compression()
+{
+  std::string big;
+  std::uint32_t x = 12345u;
+  while (big.size() < 600 * 1024 + 17)
+  {
+    x = x * 1103515245u + 12345u;
+    big += R"({"id":)" + std::to_string(x % 5000) + R"(,"tag":"t)" + std::to_string(x % 7) + R"("},)";
+  }
+
+  ThreadExecutor ex;
+
+  performance::CompressionOptions opt{};
+  opt.executor = &ex;
+  opt.parallel_min_size = 64 * 1024;
+  opt.parallel_block_size = 64 * 1024;
+
+  for (const std::string &input : {big, big.substr(0, 64 * 1024), big.substr(0, 100), std::string{}})
+  {
+    (void)input;
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+    std::string par;
+    assert(performance::gzip_compress_parallel(input, par, 6, &ex, opt.parallel_block_size));
+
+    std::string back;
+    assert(performance::gzip_decompress(par, back));
+    assert(back == input);
+#endif
+
+#if defined(VIX_HAS_ZSTD) && VIX_HAS_ZSTD
+    std::string zpar;
+    assert(performance::zstd_compress_parallel(input, zpar, 3, &ex, opt.parallel_block_size));
+
+    std::string zback;
+    assert(performance::zstd_decompress(zpar, zback));
+    assert(zback == input);
+#endif
+  }
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  // Dictionaries keep the ratio close to the serial stream.
+  std::string serial;
+  std::string par;
+  assert(performance::gzip_compress(big, serial, 6));
+  assert(performance::compress_with("gzip", big, par, opt));
+  assert(par.size() < serial.size() + serial.size() / 20);
+
+  // Without an executor the caller compresses every block itself.
+  std::string alone;
+  assert(performance::gzip_compress_parallel(big, alone, 6, nullptr, opt.parallel_block_size));
+  assert(alone == par);
+#endif
+
+  std::cout << "[OK] compression parallel blocks\n";
+}
+
+static void test_adaptive_levels()
+{
+  double cpu = 0.1;
+  auto sink = std::make_shared<observability::InMemoryMetrics>();
+
+  performance::AdaptiveCompressionOptions aopt{};
+  aopt.interval_ms = 0;
+  aopt.budget_ms = 1e9; // everything is well under budget
+  aopt.gzip = {2, 7, 4};
+  aopt.cpu_load = [&]()
+  { return cpu; };
+  aopt.metrics = sink;
+
+  auto adaptive = std::make_shared<performance::AdaptiveCompression>(aopt);
+  assert(adaptive->level("gzip") == 4);
+  assert(adaptive->level("deflate", 42) == 42);
+  assert(sink->gauge("vix_compression_level", {{"encoding", "gzip"}}) == 4.0);
+  assert(sink->gauge("vix_compression_level", {{"encoding", "br"}}) == aopt.brotli.start);
+
+  // Idle CPU and spare budget: levels climb to the upper bound.
+  for (int i = 0; i < 10; ++i)
+    adaptive->record("gzip", 4096, 1000);
+  assert(adaptive->level("gzip") == 7);
+  assert(adaptive->level("br") == aopt.brotli.start); // never sampled
+  assert(sink->gauge("vix_compression_level", {{"encoding", "gzip"}}) == 7.0);
+  assert(adaptive->average_ns_per_byte("gzip") > 0.0);
+
+  // Busy CPU: levels fall to the lower bound.
+  cpu = 0.95;
+  for (int i = 0; i < 10; ++i)
+    adaptive->record("gzip", 4096, 1000);
+  assert(adaptive->level("gzip") == 2);
+  assert(sink->gauge("vix_compression_cpu_ratio") == 0.95);
+
+  // Over budget: levels fall even when the CPU is idle.
+  aopt.budget_ms = 0.5;
+  aopt.gzip = {1, 9, 9};
+  cpu = 0.1;
+  auto slow = std::make_shared<performance::AdaptiveCompression>(aopt);
+  for (int i = 0; i < 3; ++i)
+    slow->record("gzip", 1 << 20, 5'000'000);
+  assert(slow->level("gzip") == 6);
+
+  // The budget is per budget_bytes: the same per-byte cost is cheap for
+  // 4 KiB responses, so the level climbs back.
+  aopt.budget_bytes = 4096;
+  aopt.gzip = {1, 9, 6};
+  auto sized = std::make_shared<performance::AdaptiveCompression>(aopt);
+  for (int i = 0; i < 3; ++i)
+    sized->record("gzip", 1 << 20, 5'000'000);
+  assert(sized->average_ms("gzip") > aopt.budget_ms);
+  assert(sized->level("gzip") == 9);
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  // compress_with() reports to the controller.
+  performance::CompressionOptions opt{};
+  opt.adaptive = adaptive;
+
+  std::string in(8192, 'a');
+  std::string out;
+  assert(performance::compress_with("gzip", in, out, opt));
+  assert(adaptive->average_ms("gzip") > 0.0);
+
+  std::string back;
+  assert(performance::gzip_decompress(out, back) && back == in);
+#endif
+
+  std::cout << "[OK] compression adaptive levels\n";
+}
+
+static void test_memoized_outputs()
+{
+  performance::CompressionMemoOptions mopt{};
+  mopt.max_bytes = 4096;
+  auto memo = std::make_shared<performance::CompressionMemo>(mopt);
+
+  assert(!memo->get("gzip", 6, "payload"));
+  memo->put("gzip", 6, "payload", "compressed-payload");
+
+  auto hit = memo->get("gzip", 6, "payload");
+  assert(hit && *hit == "compressed-payload");
+
+  // Same length, other bytes / level / encoding: separate entries.
+  assert(!memo->get("gzip", 6, "pAyload"));
+  assert(!memo->get("gzip", 1, "payload"));
+  assert(!memo->get("br", 6, "payload"));
+
+  // Byte budget: older entries are evicted first.
+  for (int i = 0; i < 20; ++i)
+    memo->put("gzip", 6, "body-" + std::to_string(i), std::string(512, 'z'));
+
+  const auto st = memo->stats();
+  assert(st.bytes <= mopt.max_bytes);
+  assert(st.evictions > 0);
+  assert(!memo->get("gzip", 6, "payload"));
+  assert(memo->get("gzip", 6, "body-19"));
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  performance::CompressionOptions opt{};
+  opt.min_size = 8;
+  opt.memo = std::make_shared<performance::CompressionMemo>();
+
+  HttpPipeline p;
+  p.use(performance::compression(opt));
+
+  std::string body;
+  for (int i = 0; i < 100; ++i)
+    body += R"({"feature":"flag-)" + std::to_string(i) + R"(","enabled":true},)";
+
+  std::string first;
+  for (int i = 0; i < 3; ++i)
+  {
+    auto req = make_req("/features", {{"Accept-Encoding", "gzip"}});
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+
+    p.run(req, w, [&](Request &, Response &resp)
+          { resp.ok().text(body); });
+
+    assert(res.header("Content-Encoding") == "gzip");
+    if (i == 0)
+      first = res.body();
+    assert(res.body() == first);
+  }
+
+  assert(opt.memo->stats().hits == 2);
+  assert(opt.memo->stats().entries == 1);
+
+  std::string back;
+  assert(performance::gzip_decompress(first, back) && back == body);
+#endif
+
+  std::cout << "[OK] compression memoized outputs\n";
+}
+
 int main()
 {
+  test_codecs_reuse_thread_contexts();
+  test_accept_encoding_qvalues();
+  test_zstd_roundtrip();
+  test_content_type_policy();
+  test_parallel_compression();
+  test_adaptive_levels();
+  test_memoized_outputs();
+
   HttpPipeline p;
   p.use(performance::compression({.min_size = 8}));
 
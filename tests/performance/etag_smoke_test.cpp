@@ -11,8 +11,10 @@
  *  Vix.cpp
  */
 #include <cassert>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <string>
 
@@ -20,18 +22,150 @@
 #include <vix/http/Response.hpp>
 #include <vix/http/ResponseWrapper.hpp>
 #include <vix/middleware/pipeline.hpp>
+#include <vix/middleware/performance/compression.hpp>
 #include <vix/middleware/performance/static_files.hpp>
 
 using namespace vix::middleware;
 
-static vix::http::Request make_req(std::string target)
+static vix::http::Request make_req(std::string target, std::string accept_encoding = {})
 {
   vix::http::Request::HeaderMap headers;
   headers.emplace("Host", "localhost");
+  if (!accept_encoding.empty())
+    headers.emplace("Accept-Encoding", std::move(accept_encoding));
 
   return vix::http::Request("GET", std::move(target), std::move(headers), "");
 }
 
+static void write_file(const std::filesystem::path &p, const std::string &data)
+{
+  std::ofstream f(p, std::ios::binary | std::ios::trunc);
+  f << data;
+}
+
+static void test_precompressed_sidecars()
+{
+  const auto root = std::filesystem::temp_directory_path() / "vix_static_sidecars";
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root);
+
+  write_file(root / "app.js", "console.log('plain');");
+  write_file(root / "app.js.br", "BR-BYTES");
+  write_file(root / "app.js.gz", "GZ-BYTES");
+  write_file(root / "logo.png", "PNG");
+
+  HttpPipeline p;
+  p.use(performance::static_files(root, {.mount = "/"}));
+
+  auto get = [&](const std::string &target, const std::string &accept)
+  {
+    auto req = make_req(target, accept);
+    vix::http::Response res;
+    vix::http::ResponseWrapper w(res);
+    p.run(req, w, [&](Request &, Response &resp)
+          { resp.status(404).text("nope"); });
+    return res;
+  };
+
+  auto res = get("/app.js", "gzip, br");
+  assert(res.body() == "BR-BYTES");
+  assert(res.header("Content-Encoding") == "br");
+  assert(res.header("Content-Type").find("javascript") != std::string::npos);
+  assert(!res.header("Vary").empty());
+
+  res = get("/app.js", "br;q=0.5, gzip");
+  assert(res.body() == "GZ-BYTES");
+  assert(res.header("Content-Encoding") == "gzip");
+
+  res = get("/app.js", "zstd");
+  assert(res.body() == "console.log('plain');");
+  assert(res.header("Content-Encoding").empty());
+  assert(!res.header("Vary").empty());
+
+  res = get("/logo.png", "gzip, br");
+  assert(res.body() == "PNG");
+  assert(res.header("Vary").empty());
+
+  // A sidecar older than its source is not served.
+  std::filesystem::last_write_time(
+      root / "app.js",
+      std::filesystem::last_write_time(root / "app.js.br") + std::chrono::seconds(10));
+  res = get("/app.js", "br");
+  assert(res.body() == "console.log('plain');");
+
+  std::filesystem::remove_all(root);
+  std::cout << "[OK] static_files precompressed sidecars\n";
+}
+
+namespace
+{
+  class InlineExecutor final : public vix::executor::IExecutor
+  {
+  public:
+    bool post(std::function<void()> fn, vix::executor::TaskOptions = {}) override
+    {
+      fn();
+      return true;
+    }
+  };
+}
+
+static void test_generate_sidecars()
+{
+  const auto root = std::filesystem::temp_directory_path() / "vix_static_generate";
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root / "css");
+
+  std::string css;
+  for (int i = 0; i < 200; ++i)
+    css += ".c" + std::to_string(i) + " { color: red; margin: 0; }\n";
+
+  write_file(root / "css" / "site.css", css);
+  write_file(root / "tiny.txt", "hi");
+  write_file(root / "photo.jpg", std::string(4096, 'x'));
+
+  InlineExecutor ex;
+  performance::SidecarReport report;
+  assert(performance::generate_sidecars_async(
+      ex, root, {}, [&](const performance::SidecarReport &r)
+      { report = r; }));
+
+  assert(report.scanned == 3);
+  assert(report.failed == 0);
+
+#if defined(VIX_HAS_ZLIB) && VIX_HAS_ZLIB
+  assert(std::filesystem::exists(root / "css" / "site.css.gz"));
+  assert(!std::filesystem::exists(root / "tiny.txt.gz"));
+  assert(!std::filesystem::exists(root / "photo.jpg.gz"));
+
+  std::string gz;
+  assert(performance::read_file_to_string(root / "css" / "site.css.gz", gz));
+  std::string back;
+  assert(performance::gzip_decompress(gz, back));
+  assert(back == css);
+
+  HttpPipeline p;
+  p.use(performance::static_files(root, {.mount = "/"}));
+
+  auto req = make_req("/css/site.css", "gzip");
+  vix::http::Response res;
+  vix::http::ResponseWrapper w(res);
+  p.run(req, w, [&](Request &, Response &resp)
+        { resp.status(404).text("nope"); });
+
+  assert(res.header("Content-Encoding") == "gzip");
+  assert(res.body() == gz);
+
+  // Second pass: every sidecar is up to date.
+  const auto again = performance::generate_sidecars(root);
+  assert(again.written == 0);
+  assert(again.fresh >= 1);
+#endif
+
+  std::filesystem::remove_all(root);
+  std::cout << "[OK] static_files sidecar generation\n";
+}
+
 int main()
 {
   const auto root = std::filesystem::temp_directory_path() / "vix_static_smoke";
@@ -55,5 +189,8 @@ int main()
   assert(res.body().find("OK") != std::string::npos);
 
   std::cout << "[OK] static_files smoke\n";
+
+  test_precompressed_sidecars();
+  test_generate_sidecars();
   return 0;
 }
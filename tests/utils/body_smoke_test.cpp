@@ -0,0 +1,46 @@
+/**
+ *
+ *  @file body_smoke_test.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ */
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <vix/http/Request.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/middleware/utils/body.hpp>
+
+int main()
+{
+  using namespace vix::middleware::utils;
+
+  vix::http::Request::HeaderMap headers;
+  headers.emplace("Host", "localhost");
+  vix::http::Request req("POST", "/", std::move(headers), std::string(4096, 'a'));
+
+  const std::string_view rv = body_view(req);
+  assert(rv.size() == 4096);
+  assert(rv.data() == req.body().data());
+
+  vix::http::Response res;
+  replace_body(res, std::string(2048, 'b'));
+
+  const std::string_view v = body_view(res);
+  assert(v.size() == 2048 && v.front() == 'b');
+  assert(v.data() == res.body().data());
+
+  replace_body(res, std::string{});
+  assert(body_view(res).empty());
+
+  std::cout << "[OK] body view and replace\n";
+  return 0;
+}